@@ -16,15 +16,21 @@
 	on each thread.
 
 	3) At the beginning of the frame, fill the Im3d::AppData struct for *all* contexts which will be used 
-	during the frame. The simplest approach is to fill this once on the main thread and then copy the
-	result into each per-thread context. See the integration examples for how to fill the AppData struct.
+	during the frame. The simplest approach is to fill this once on the main thread and then share the
+	main context's Im3d::FrameConstants with each per-thread context via Context::setFrameConstants().
+	See the integration examples for how to fill the AppData struct.
 
 	4) Towards the end of the frame, merge each per-thread context into the main thread via Im3d::MergeContexts(), 
 	then call Im3d::EndFrame() and draw the combined draw lists. This requires synchronization to ensure that 
 	threads cannot modify either context during the merge.
+
+	Alternatively, #define IM3D_THREAD_SAFE_SUBMISSION 1 to skip steps 1-4: Im3d calls from any thread are routed to a
+	per-thread producer context which Im3d creates, resets and merges automatically (see Context::getThreadContext()).
+	Threads must still be synchronized before Im3d::EndFrame().
 */
 #include "im3d_example.h"
 
+#include <cstring>
 #include <thread>
 
 static const int     kThreadCountMax  = 6;
@@ -44,6 +50,7 @@ static Im3d::Color   g_ThreadColors[kThreadCountMax] =
 
 static void ThreadDraw(int _threadIndex);
 static void MainThreadDraw();
+static void CheckTextMerge();
 
 int main(int, char**)
 {
@@ -53,6 +60,8 @@ int main(int, char**)
 		return 1;
 	}
 
+	CheckTextMerge();
+
 	for (int i = 0; i < kThreadCountMax; ++i)
 	{
 		float threadX = (float)i / (float)kThreadCountMax * 10.0f - 5.0f;
@@ -64,10 +73,10 @@ int main(int, char**)
 	// At this point we have updated the default context and filled its AppData struct. 
 
 	// Each separate context could potentially use different AppData (e.g. different cameras/viewports). Here 
-	// we just copy the default for simplicity.
+	// all contexts reference the default context's frame constants, so reset() doesn't need to process AppData.
 		for (auto& ctx : g_ThreadContexts)
 		{
-			ctx.getAppData() = Im3d::GetAppData();
+			ctx.setFrameConstants(&Im3d::GetContext().getFrameConstants());
 
 			ctx.reset(); // equivalent to calling Im3d::NewFrame() on the thread
 		}
@@ -106,7 +115,7 @@ void ThreadDraw(int _threadIndex)
 	//Im3d::NewFrame(); // in this example we call ctx.reset() outside the thread, which is equivalent
 	
  // Gizmos work, however the application is responsible for isolating inputs between multiple contexts.
- // In this example we simply copy AppData from the main thread, therefore it's possible to interact with
+ // In this example we simply share AppData from the main thread, therefore it's possible to interact with
  // multiple gizmos simultaneously.
 	Im3d::Gizmo("Gizmo", (float*)&g_ThreadGizmoTest[_threadIndex]);
 
@@ -215,4 +224,73 @@ void MainThreadDraw()
 	}
 
 	ImGui::End();
-}
\ No newline at end of file
+}
+
+// Return the number of text entries on _layerId in _ctx's text draw lists which match _str.
+static int CountText(const Im3d::Context& _ctx, Im3d::Id _layerId, const char* _str)
+{
+	int ret = 0;
+	for (Im3d::U32 i = 0; i < _ctx.getTextDrawListCount(); ++i)
+	{
+		const Im3d::TextDrawList& textDrawList = _ctx.getTextDrawLists()[i];
+		if (textDrawList.m_layerId != _layerId)
+		{
+			continue;
+		}
+		for (Im3d::U32 j = 0; j < textDrawList.m_textDataCount; ++j)
+		{
+			const Im3d::TextData& textData = textDrawList.m_textData[j];
+			if (textData.m_textLength == strlen(_str) && memcmp(textDrawList.m_textBuffer + textData.m_textBufferOffset, _str, textData.m_textLength) == 0)
+			{
+				++ret;
+			}
+		}
+	}
+	return ret;
+}
+
+// Check that Im3d::MergeContexts() moves text from several contexts and layers (including layers which don't exist in the destination
+// and interned strings) into the matching layers of the destination. Runs once at startup, the asserts are the test.
+void CheckTextMerge()
+{
+	Im3d::Context dst, srcA, srcB;
+	Im3d::Context* contexts[] = { &dst, &srcA, &srcB };
+	for (Im3d::Context* ctx : contexts)
+	{
+		ctx->getAppData().m_viewportSize = Im3d::Vec2(640.0f, 480.0f);
+		ctx->reset();
+	}
+	const Im3d::Id layer1 = Im3d::MakeId("CheckTextMerge1");
+	const Im3d::Id layer2 = Im3d::MakeId("CheckTextMerge2");
+	const Im3d::Vec3 pos(0.0f);
+
+	Im3d::Text(dst, pos, 0, "dst0");
+
+	Im3d::Text(srcA, pos, 0, "a0");
+	Im3d::PushLayerId(srcA, layer1);
+		Im3d::Text(srcA, pos, 0, "a1 %d", 1);
+	Im3d::PopLayerId(srcA);
+
+	srcB.internText("unused interned string");
+	const Im3d::Id interned = srcB.internText("b2 interned");
+	Im3d::PushLayerId(srcB, layer2);
+		Im3d::Text(srcB, pos, 0, "b2");
+		srcB.text(pos, 1.0f, Im3d::Color_White, Im3d::TextFlags_Default, interned);
+	Im3d::PopLayerId(srcB);
+	Im3d::PushLayerId(srcB, layer1);
+		Im3d::Text(srcB, pos, 0, "b1");
+	Im3d::PopLayerId(srcB);
+
+	Im3d::MergeContexts(dst, srcA);
+	Im3d::MergeContexts(dst, srcB);
+	dst.endFrame();
+
+	IM3D_ASSERT(CountText(dst, 0, "dst0") == 1);
+	IM3D_ASSERT(CountText(dst, 0, "a0") == 1);
+	IM3D_ASSERT(CountText(dst, layer1, "a1 1") == 1);
+	IM3D_ASSERT(CountText(dst, layer1, "b1") == 1);
+	IM3D_ASSERT(CountText(dst, layer2, "b2") == 1);
+	IM3D_ASSERT(CountText(dst, layer2, "b2 interned") == 1);
+	IM3D_ASSERT(CountText(dst, layer2, "a0") == 0);
+	IM3D_ASSERT(CountText(dst, 0, "unused interned string") == 0);
+}
@@ -1,5 +1,30 @@
 /*	CHANGE LOG
 	==========
+	2026-10-19 (v1.19) - Fixed text merging in MergeContexts() (text was added to the wrong layer and the source text buffer was copied once per layer).
+	                   - Thread-safe submission (IM3D_THREAD_SAFE_SUBMISSION), per-thread producer contexts are merged during EndFrame(), idle producers are destroyed (IM3D_PRODUCER_IDLE_FRAMES).
+	                   - Explicit context overloads for all free functions (e.g. DrawSphere(ctx, ...)), IM3D_CONTEXT_LOOKUP to override the context lookup.
+	                   - Recorder, a lightweight inline-storage alternative to Context for fine-grained tasks.
+	                   - FrameConstants, per-frame data derived from AppData which can be shared between contexts (see Context::setFrameConstants()).
+	                   - Batched IsVisible() for arrays of spheres/boxes, SSE implementation (IM3D_SSE).
+	                   - IM3D_CULL_PRIMITIVES_POST_PASS culls individual points/lines/triangles during EndFrame(), see Context::getCulledPrimitiveCount().
+	                   - AppData::m_minPixelSize culls (or collapses to a point) shapes and primitives with a sub-threshold projected size.
+	                   - PushCullBounds()/PushCullSphere()/PopCullBounds() cull scopes.
+	                   - OcclusionBuffer, software hierarchical depth buffer for occlusion culling (see LayerPolicy::m_occlusionCulling).
+	                   - Per-layer max distance, distance fade and LOD bias (Context::setLayerPolicy()).
+	                   - Multi-view output, culled and sorted draw lists per view over shared vertex data (Context::setViews()).
+	                   - IM3D_CULL_PRIMITIVES bounds are inflated by the per-vertex size instead of a fixed world space offset, Context::getCullRate().
+	                   - IM3D_COMPACT_PRIMITIVES removes fully transparent/degenerate primitives during EndFrame(), Begin*()/End() blocks are skipped if alpha is 0.
+	                   - Streaming mode for unsorted primitives with bounded memory (AppData::flushCallback, AppData::m_flushVertexCount).
+	                   - Single pass text formatting, TextUnformatted().
+	                   - Built-in text layout, text draw lists are converted to screen-aligned glyph quads per layer during EndFrame() (AppData::m_font).
+	                   - Text culling (IM3D_CULL_TEXT) and screen space label decluttering (AppData::m_textDeclutterSize).
+	                   - Interned text, strings stored once per context and referenced by ID across frames (InternText(), TextInterned()).
+	                   - Compile time string IDs (IM3D_STATIC_ID(), MakeId(StaticId)), used internally by the gizmos.
+	                   - Object picking along the cursor ray (PickSphere(), PickBox(), PickCapsule(), GetPickId()), batched SSE implementation.
+	                   - GizmoGroup(), a single gizmo which applies its change to many transforms (SSE, optional AppData::parallelForCallback).
+	                   - Gizmo rings use cached unit circles per level of detail with an SSE occlusion alpha pass, gizmo geometry is appended in bulk.
+	                   - AppData::m_deferHotResolution, resolve the hot gizmo during EndFrame() (including merged contexts) rather than in call order.
+	                   - InteractionState, gizmo hot/active state shared between contexts with lock-free nearest hot resolution (see Context::setInteractionState()).
 	2025-09-14 (v1.18) - Improved DrawCone() and DrawConeFilled(); API matches other high order shape functions. Old behvaior is still enabled by default, see IM3D_USE_DEPRECATED_DRAW_CONE in im3d_config.h.
 	2025-05-05 (v1.17) - IM3D_GIZMO_LAYER_ID forces all gizmos to be drawn to a layer when defined.
 	                   - Fix for snapping with a non-empty matrix stack.
@@ -56,6 +81,25 @@
 #ifndef IM3D_CULL_GIZMOS
 	#define IM3D_CULL_GIZMOS 0
 #endif
+#ifndef IM3D_CULL_PRIMITIVES_POST_PASS
+	#define IM3D_CULL_PRIMITIVES_POST_PASS 0
+#endif
+#ifndef IM3D_CULL_TEXT
+	#define IM3D_CULL_TEXT 0
+#endif
+#ifndef IM3D_COMPACT_PRIMITIVES
+	#define IM3D_COMPACT_PRIMITIVES 0
+#endif
+#ifndef IM3D_THREAD_SAFE_SUBMISSION
+	#define IM3D_THREAD_SAFE_SUBMISSION 0
+#endif
+#ifndef IM3D_PRODUCER_IDLE_FRAMES
+	#define IM3D_PRODUCER_IDLE_FRAMES 60
+#endif
+
+#if IM3D_THREAD_SAFE_SUBMISSION
+	#include <new> // placement new for producer contexts
+#endif
 
 // Compiler
 #if defined(__GNUC__)
@@ -76,6 +120,34 @@
 	#define if_unlikely(e) if(!!(e))
 #endif
 
+// Atomics (return true if the exchange happened).
+#if defined(IM3D_COMPILER_GNU)
+	#define IM3D_ATOMIC_LOAD_PTR(_ptr)                     __atomic_load_n((_ptr), __ATOMIC_ACQUIRE)
+	#define IM3D_ATOMIC_CAS_PTR(_ptr, _expected, _desired) __sync_bool_compare_and_swap((_ptr), (_expected), (_desired))
+	#define IM3D_ATOMIC_INC_U32(_ptr)                      __sync_add_and_fetch((_ptr), 1u)
+	#define IM3D_ATOMIC_LOAD_U64(_ptr)                     __atomic_load_n((_ptr), __ATOMIC_ACQUIRE)
+	#define IM3D_ATOMIC_CAS_U64(_ptr, _expected, _desired) __sync_bool_compare_and_swap((_ptr), (_expected), (_desired))
+#elif defined(IM3D_COMPILER_MSVC)
+	#include <intrin.h>
+	#define IM3D_ATOMIC_LOAD_PTR(_ptr)                     ((decltype(+*(_ptr)))_InterlockedCompareExchangePointer((void* volatile*)(_ptr), nullptr, nullptr)) // CAS with expected == desired is an atomic read
+	#define IM3D_ATOMIC_CAS_PTR(_ptr, _expected, _desired) (_InterlockedCompareExchangePointer((void* volatile*)(_ptr), (void*)(_desired), (void*)(_expected)) == (void*)(_expected))
+	#define IM3D_ATOMIC_INC_U32(_ptr)                      ((U32)_InterlockedIncrement((volatile long*)(_ptr)))
+	#define IM3D_ATOMIC_LOAD_U64(_ptr)                     ((U64)_InterlockedCompareExchange64((volatile __int64*)(_ptr), 0, 0)) // plain 64 bit reads aren't atomic on x86
+	#define IM3D_ATOMIC_CAS_U64(_ptr, _expected, _desired) (_InterlockedCompareExchange64((volatile __int64*)(_ptr), (__int64)(_desired), (__int64)(_expected)) == (__int64)(_expected))
+#endif
+
+// SIMD, enabled by default if the target supports SSE2.
+#ifndef IM3D_SSE
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define IM3D_SSE 1
+	#else
+		#define IM3D_SSE 0
+	#endif
+#endif
+#if IM3D_SSE
+	#include <xmmintrin.h>
+#endif
+
 // Internal config/debugging.
 #define IM3D_RELATIVE_SNAP 0  // Snap relative to the gizmo stored position/rotation/scale (else snap is absolute).
 #define IM3D_GIZMO_DEBUG   0  // Draw debug bounds for gizmo intersections.
@@ -113,146 +185,221 @@ Color::Color(float _r, float _g, float _b, float _a)
 	v |= (U32)(_a * 255.0f);
 }
 
-void Im3d::MulMatrix(const Mat4& _mat4)
+// Return true if a shape with bounding sphere _origin, _radius should be skipped, either because the current cull scope was culled or
+// the current alpha is 0, because it is beyond the layer's max distance, because it is occluded or because it projects to less than AppData::m_minPixelSize.
+// In the latter case the shape is drawn as a single point if AppData::m_minPixelSizeAsPoint is set. The bounding sphere is in the space of the
+// current matrix.
+static bool SkipShape(Context& _ctx, const Vec3& _origin, float _radius)
 {
-	Context& ctx = GetContext();
-	ctx.setMatrix(ctx.getMatrix() * _mat4);
+	if (_ctx.isCullScopeCulled() || _ctx.getAlpha() == 0.0f)
+	{
+		return true;
+	}
+	const AppData& appData = _ctx.getAppData();
+	const Mat4& matrix = _ctx.getMatrix();
+	const Vec3 scale = matrix.getScale();
+	const Vec3 origin = matrix * _origin;
+	const float radius = _radius * Max(scale.x, Max(scale.y, scale.z));
+	const float maxDistance = _ctx.getLayerPolicy().m_maxDistance;
+	if (maxDistance > 0.0f && Length(origin - appData.m_viewOrigin) - radius > maxDistance)
+	{
+		return true;
+	}
+	if (_ctx.isOccluded(origin, radius))
+	{
+		return true;
+	}
+	if_likely (appData.m_minPixelSize <= 0.0f)
+	{
+		return false;
+	}
+	const float pixels = _ctx.worldSizeToPixels(origin, radius * 2.0f);
+	if (pixels >= appData.m_minPixelSize)
+	{
+		return false;
+	}
+	if (appData.m_minPixelSizeAsPoint)
+	{
+		DrawPoint(_ctx, _origin, Max(pixels, 1.0f), _ctx.getColor());
+	}
+	return true;
 }
-void Im3d::Translate(float _x, float _y, float _z)
+
+// Return true if the projected bounds of _count vertices are smaller than AppData::m_minPixelSize.
+static bool BelowMinPixelSize(Context& _ctx, const VertexData* _vdata, U32 _count)
 {
-	Context& ctx = GetContext();
-	ctx.setMatrix(ctx.getMatrix() * Translation(Vec3(_x, _y, _z)));
+	Vec3 bmin = Vec3(_vdata[0].m_positionSize);
+	Vec3 bmax = bmin;
+	for (U32 i = 1; i < _count; ++i)
+	{
+		const Vec3 p = Vec3(_vdata[i].m_positionSize);
+		bmin = Min(bmin, p);
+		bmax = Max(bmax, p);
+	}
+	return _ctx.worldSizeToPixels((bmin + bmax) * 0.5f, Length(bmax - bmin)) < _ctx.getAppData().m_minPixelSize;
 }
-void Im3d::Translate(const Vec3& _vec3)
+
+// Return true if the bounds of _count vertices are entirely farther than _policy.m_maxDistance from _viewOrigin.
+static bool BeyondMaxDistance(const LayerPolicy& _policy, const Vec3& _viewOrigin, const VertexData* _vdata, U32 _count)
 {
-	Context& ctx = GetContext();
-	ctx.setMatrix(ctx.getMatrix() * Translation(_vec3));
+	Vec3 bmin = Vec3(_vdata[0].m_positionSize);
+	Vec3 bmax = bmin;
+	for (U32 i = 1; i < _count; ++i)
+	{
+		const Vec3 p = Vec3(_vdata[i].m_positionSize);
+		bmin = Min(bmin, p);
+		bmax = Max(bmax, p);
+	}
+	const Vec3 nearest = Max(bmin, Min(_viewOrigin, bmax));
+	return Length2(nearest - _viewOrigin) > _policy.m_maxDistance * _policy.m_maxDistance;
 }
-void Im3d::Rotate(const Vec3& _axis, float _angle)
+
+// Return the alpha multiplier for a vertex at _position given the fade band of _policy.
+static float DistanceFade(const LayerPolicy& _policy, const Vec3& _viewOrigin, const Vec3& _position)
 {
-	Context& ctx = GetContext();
-	ctx.setMatrix(ctx.getMatrix() * Mat4(Rotation(_axis, _angle)));
+	return Clamp((_policy.m_maxDistance - Length(_position - _viewOrigin)) / _policy.m_fadeDistance, 0.0f, 1.0f);
+}
+
+void Im3d::MulMatrix(Context& _ctx, const Mat4& _mat4)
+{
+	_ctx.setMatrix(_ctx.getMatrix() * _mat4);
 }
-void Im3d::Rotate(const Mat3& _rotation)
+void Im3d::Translate(Context& _ctx, float _x, float _y, float _z)
 {
-	Context& ctx = GetContext();
-	ctx.setMatrix(ctx.getMatrix() * Mat4(_rotation));
+	_ctx.setMatrix(_ctx.getMatrix() * Translation(Vec3(_x, _y, _z)));
 }
-void Im3d::Scale(float _x, float _y, float _z)
+void Im3d::Translate(Context& _ctx, const Vec3& _vec3)
 {
-	Context& ctx = GetContext();
-	ctx.setMatrix(ctx.getMatrix() * Mat4(Scale(Vec3(_x, _y, _z))));
+	_ctx.setMatrix(_ctx.getMatrix() * Translation(_vec3));
+}
+void Im3d::Rotate(Context& _ctx, const Vec3& _axis, float _angle)
+{
+	_ctx.setMatrix(_ctx.getMatrix() * Mat4(Rotation(_axis, _angle)));
+}
+void Im3d::Rotate(Context& _ctx, const Mat3& _rotation)
+{
+	_ctx.setMatrix(_ctx.getMatrix() * Mat4(_rotation));
+}
+void Im3d::Scale(Context& _ctx, float _x, float _y, float _z)
+{
+	_ctx.setMatrix(_ctx.getMatrix() * Mat4(Scale(Vec3(_x, _y, _z))));
 }
 
 
-void Im3d::DrawXyzAxes()
+void Im3d::DrawXyzAxes(Context& _ctx)
 {
-	Context& ctx = GetContext();
-	ctx.pushColor(ctx.getColor());
-	ctx.begin(PrimitiveMode_Lines);
-		ctx.vertex(Vec3(0.0f, 0.0f, 0.0f), ctx.getSize(), Color_Red);
-		ctx.vertex(Vec3(1.0f, 0.0f, 0.0f), ctx.getSize(), Color_Red);
-		ctx.vertex(Vec3(0.0f, 0.0f, 0.0f), ctx.getSize(), Color_Green);
-		ctx.vertex(Vec3(0.0f, 1.0f, 0.0f), ctx.getSize(), Color_Green);
-		ctx.vertex(Vec3(0.0f, 0.0f, 0.0f), ctx.getSize(), Color_Blue);
-		ctx.vertex(Vec3(0.0f, 0.0f, 1.0f), ctx.getSize(), Color_Blue);
-	ctx.end();
-	ctx.popColor();
+	_ctx.pushColor(_ctx.getColor());
+	_ctx.begin(PrimitiveMode_Lines);
+		_ctx.vertex(Vec3(0.0f, 0.0f, 0.0f), _ctx.getSize(), Color_Red);
+		_ctx.vertex(Vec3(1.0f, 0.0f, 0.0f), _ctx.getSize(), Color_Red);
+		_ctx.vertex(Vec3(0.0f, 0.0f, 0.0f), _ctx.getSize(), Color_Green);
+		_ctx.vertex(Vec3(0.0f, 1.0f, 0.0f), _ctx.getSize(), Color_Green);
+		_ctx.vertex(Vec3(0.0f, 0.0f, 0.0f), _ctx.getSize(), Color_Blue);
+		_ctx.vertex(Vec3(0.0f, 0.0f, 1.0f), _ctx.getSize(), Color_Blue);
+	_ctx.end();
+	_ctx.popColor();
 
 }
-void Im3d::DrawPoint(const Vec3& _position, float _size, Color _color)
+void Im3d::DrawPoint(Context& _ctx, const Vec3& _position, float _size, Color _color)
 {
-	Context& ctx = GetContext();
-	ctx.begin(PrimitiveMode_Points);
-		ctx.vertex(_position, _size, _color);
-	ctx.end();
+	_ctx.begin(PrimitiveMode_Points);
+		_ctx.vertex(_position, _size, _color);
+	_ctx.end();
 }
-void Im3d::DrawLine(const Vec3& _a, const Vec3& _b, float _size, Color _color)
+void Im3d::DrawLine(Context& _ctx, const Vec3& _a, const Vec3& _b, float _size, Color _color)
 {
-	Context& ctx = GetContext();
-	ctx.begin(PrimitiveMode_Lines);
-		ctx.vertex(_a, _size, _color);
-		ctx.vertex(_b, _size, _color);
-	ctx.end();
+	_ctx.begin(PrimitiveMode_Lines);
+		_ctx.vertex(_a, _size, _color);
+		_ctx.vertex(_b, _size, _color);
+	_ctx.end();
 }
-void Im3d::DrawQuad(const Vec3& _a, const Vec3& _b, const Vec3& _c, const Vec3& _d)
+void Im3d::DrawQuad(Context& _ctx, const Vec3& _a, const Vec3& _b, const Vec3& _c, const Vec3& _d)
 {
-	Context& ctx = GetContext();
-	ctx.begin(PrimitiveMode_LineLoop);
-		ctx.vertex(_a);
-		ctx.vertex(_b);
-		ctx.vertex(_c);
-		ctx.vertex(_d);
-	ctx.end();
+	_ctx.begin(PrimitiveMode_LineLoop);
+		_ctx.vertex(_a);
+		_ctx.vertex(_b);
+		_ctx.vertex(_c);
+		_ctx.vertex(_d);
+	_ctx.end();
 }
-void Im3d::DrawQuad(const Vec3& _origin, const Vec3& _normal, const Vec2& _size)
+void Im3d::DrawQuad(Context& _ctx, const Vec3& _origin, const Vec3& _normal, const Vec2& _size)
 {
-	Context& ctx = GetContext();
-	ctx.pushMatrix(ctx.getMatrix() * LookAt(_origin, _origin + _normal, ctx.getAppData().m_worldUp));
-	DrawQuad(
+	if (SkipShape(_ctx, _origin, Length(_size)))
+	{
+		return;
+	}
+	_ctx.pushMatrix(_ctx.getMatrix() * LookAt(_origin, _origin + _normal, _ctx.getAppData().m_worldUp));
+	DrawQuad(_ctx,
 		Vec3(-_size.x,  _size.y, 0.0f),
 		Vec3( _size.x,  _size.y, 0.0f),
 		Vec3( _size.x, -_size.y, 0.0f),
 		Vec3(-_size.x, -_size.y, 0.0f)
 		);
-	ctx.popMatrix();
+	_ctx.popMatrix();
 }
-void Im3d::DrawQuadFilled(const Vec3& _a, const Vec3& _b, const Vec3& _c, const Vec3& _d)
+void Im3d::DrawQuadFilled(Context& _ctx, const Vec3& _a, const Vec3& _b, const Vec3& _c, const Vec3& _d)
 {
-	Context& ctx = GetContext();
-	ctx.begin(PrimitiveMode_Triangles);
-		ctx.vertex(_a);
-		ctx.vertex(_b);
-		ctx.vertex(_c);
-		ctx.vertex(_a);
-		ctx.vertex(_c);
-		ctx.vertex(_d);
-	ctx.end();
+	_ctx.begin(PrimitiveMode_Triangles);
+		_ctx.vertex(_a);
+		_ctx.vertex(_b);
+		_ctx.vertex(_c);
+		_ctx.vertex(_a);
+		_ctx.vertex(_c);
+		_ctx.vertex(_d);
+	_ctx.end();
 }
-void Im3d::DrawQuadFilled(const Vec3& _origin, const Vec3& _normal, const Vec2& _size)
+void Im3d::DrawQuadFilled(Context& _ctx, const Vec3& _origin, const Vec3& _normal, const Vec2& _size)
 {
-	Context& ctx = GetContext();
-	ctx.pushMatrix(ctx.getMatrix() * LookAt(_origin, _origin + _normal, ctx.getAppData().m_worldUp));
-	DrawQuadFilled(
+	if (SkipShape(_ctx, _origin, Length(_size)))
+	{
+		return;
+	}
+	_ctx.pushMatrix(_ctx.getMatrix() * LookAt(_origin, _origin + _normal, _ctx.getAppData().m_worldUp));
+	DrawQuadFilled(_ctx,
 		Vec3(-_size.x, -_size.y, 0.0f),
 		Vec3( _size.x, -_size.y, 0.0f),
 		Vec3( _size.x,  _size.y, 0.0f),
 		Vec3(-_size.x,  _size.y, 0.0f)
 		);
-	ctx.popMatrix();
+	_ctx.popMatrix();
 }
-void Im3d::DrawCircle(const Vec3& _origin, const Vec3& _normal, float _radius, int _detail)
+void Im3d::DrawCircle(Context& _ctx, const Vec3& _origin, const Vec3& _normal, float _radius, int _detail)
 {
-	Context& ctx = GetContext();
+	if (SkipShape(_ctx, _origin, _radius))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible(_origin, _radius))
+		if (!_ctx.isVisible(_origin, _radius))
 		{
 			return;
 		}
 	#endif
 
-
 	if (_detail < 0)
 	{
-		_detail = ctx.estimateLevelOfDetail(_origin, _radius, 8, 48);
+		_detail = _ctx.estimateLevelOfDetail(_origin, _radius, 8, 48);
 	}
 	_detail = Max(_detail, 3);
 
- 	ctx.pushMatrix(ctx.getMatrix() * LookAt(_origin, _origin + _normal, ctx.getAppData().m_worldUp));
-	ctx.begin(PrimitiveMode_LineLoop);
+ 	_ctx.pushMatrix(_ctx.getMatrix() * LookAt(_origin, _origin + _normal, _ctx.getAppData().m_worldUp));
+	_ctx.begin(PrimitiveMode_LineLoop);
 		for (int i = 0; i < _detail; ++i)
 		{
 			float rad = TwoPi * ((float)i / (float)_detail);
-			ctx.vertex(Vec3(cosf(rad) * _radius, sinf(rad) * _radius, 0.0f));
+			_ctx.vertex(Vec3(cosf(rad) * _radius, sinf(rad) * _radius, 0.0f));
 		}
-	ctx.end();
-	ctx.popMatrix();
+	_ctx.end();
+	_ctx.popMatrix();
 }
-void Im3d::DrawCircleFilled(const Vec3& _origin, const Vec3& _normal, float _radius, int _detail)
+void Im3d::DrawCircleFilled(Context& _ctx, const Vec3& _origin, const Vec3& _normal, float _radius, int _detail)
 {
-	Context& ctx = GetContext();
+	if (SkipShape(_ctx, _origin, _radius))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible(_origin, _radius))
+		if (!_ctx.isVisible(_origin, _radius))
 		{
 			return;
 		}
@@ -260,33 +407,36 @@ void Im3d::DrawCircleFilled(const Vec3& _origin, const Vec3& _normal, float _rad
 
 	if (_detail < 0)
 	{
-		_detail = ctx.estimateLevelOfDetail(_origin, _radius, 8, 64);
+		_detail = _ctx.estimateLevelOfDetail(_origin, _radius, 8, 64);
 	}
 	_detail = Max(_detail, 3);
 
- 	ctx.pushMatrix(ctx.getMatrix() * LookAt(_origin, _origin + _normal, ctx.getAppData().m_worldUp));
-	ctx.begin(PrimitiveMode_Triangles);
+ 	_ctx.pushMatrix(_ctx.getMatrix() * LookAt(_origin, _origin + _normal, _ctx.getAppData().m_worldUp));
+	_ctx.begin(PrimitiveMode_Triangles);
 		float cp = _radius;
 		float sp = 0.0f;
 		for (int i = 1; i <= _detail; ++i)
 		{
-			ctx.vertex(Vec3(0.0f, 0.0f, 0.0f));
-			ctx.vertex(Vec3(cp, sp, 0.0f));
+			_ctx.vertex(Vec3(0.0f, 0.0f, 0.0f));
+			_ctx.vertex(Vec3(cp, sp, 0.0f));
 			float rad = TwoPi * ((float)i / (float)_detail);
 			float c = cosf(rad) * _radius;
 			float s = sinf(rad) * _radius;
-			ctx.vertex(Vec3(c, s, 0.0f));
+			_ctx.vertex(Vec3(c, s, 0.0f));
 			cp = c;
 			sp = s;
 		}
-	ctx.end();
-	ctx.popMatrix();
+	_ctx.end();
+	_ctx.popMatrix();
 }
-void Im3d::DrawSphere(const Vec3& _origin, float _radius, int _detail)
+void Im3d::DrawSphere(Context& _ctx, const Vec3& _origin, float _radius, int _detail)
 {
-	Context& ctx = GetContext();
+	if (SkipShape(_ctx, _origin, _radius))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible(_origin, _radius))
+		if (!_ctx.isVisible(_origin, _radius))
 		{
 			return;
 		}
@@ -294,40 +444,43 @@ void Im3d::DrawSphere(const Vec3& _origin, float _radius, int _detail)
 
 	if (_detail < 0)
 	{
-		_detail = ctx.estimateLevelOfDetail(_origin, _radius, 8, 48);
+		_detail = _ctx.estimateLevelOfDetail(_origin, _radius, 8, 48);
 	}
 	_detail = Max(_detail, 3);
 
  // xy circle
-	ctx.begin(PrimitiveMode_LineLoop);
+	_ctx.begin(PrimitiveMode_LineLoop);
 		for (int i = 0; i < _detail; ++i)
 		{
 			float rad = TwoPi * ((float)i / (float)_detail);
-			ctx.vertex(Vec3(cosf(rad) * _radius + _origin.x, sinf(rad) * _radius + _origin.y, 0.0f + _origin.z));
+			_ctx.vertex(Vec3(cosf(rad) * _radius + _origin.x, sinf(rad) * _radius + _origin.y, 0.0f + _origin.z));
 		}
-	ctx.end();
+	_ctx.end();
  // xz circle
-	ctx.begin(PrimitiveMode_LineLoop);
+	_ctx.begin(PrimitiveMode_LineLoop);
 		for (int i = 0; i < _detail; ++i)
 		{
 			float rad = TwoPi * ((float)i / (float)_detail);
-			ctx.vertex(Vec3(cosf(rad) * _radius + _origin.x, 0.0f + _origin.y, sinf(rad) * _radius + _origin.z));
+			_ctx.vertex(Vec3(cosf(rad) * _radius + _origin.x, 0.0f + _origin.y, sinf(rad) * _radius + _origin.z));
 		}
-	ctx.end();
+	_ctx.end();
  // yz circle
-	ctx.begin(PrimitiveMode_LineLoop);
+	_ctx.begin(PrimitiveMode_LineLoop);
 		for (int i = 0; i < _detail; ++i)
 		{
 			float rad = TwoPi * ((float)i / (float)_detail);
-			ctx.vertex(Vec3(0.0f + _origin.x, cosf(rad) * _radius + _origin.y, sinf(rad) * _radius + _origin.z));
+			_ctx.vertex(Vec3(0.0f + _origin.x, cosf(rad) * _radius + _origin.y, sinf(rad) * _radius + _origin.z));
 		}
-	ctx.end();
+	_ctx.end();
 }
-void Im3d::DrawSphereFilled(const Vec3& _origin, float _radius, int _detail)
+void Im3d::DrawSphereFilled(Context& _ctx, const Vec3& _origin, float _radius, int _detail)
 {
-	Context& ctx = GetContext();
+	if (SkipShape(_ctx, _origin, _radius))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible(_origin, _radius))
+		if (!_ctx.isVisible(_origin, _radius))
 		{
 			return;
 		}
@@ -335,11 +488,11 @@ void Im3d::DrawSphereFilled(const Vec3& _origin, float _radius, int _detail)
 
 	if (_detail < 0)
 	{
-		_detail = ctx.estimateLevelOfDetail(_origin, _radius, 12, 32);
+		_detail = _ctx.estimateLevelOfDetail(_origin, _radius, 12, 32);
 	}
 	_detail = Max(_detail, 6);
 
-	ctx.begin(PrimitiveMode_Triangles);
+	_ctx.begin(PrimitiveMode_Triangles);
 		float yp = -_radius;
 		float rp = 0.0f;
 		for (int i = 1; i <= _detail / 2; ++i)
@@ -356,13 +509,13 @@ void Im3d::DrawSphereFilled(const Vec3& _origin, float _radius, int _detail)
 				float z = sinf(x);
 				x = cosf(x);
 
-				ctx.vertex(Vec3(xp * rp + _origin.x, yp + _origin.y, zp * rp + _origin.z));
-				ctx.vertex(Vec3(xp * r  + _origin.x, y  + _origin.y, zp * r  + _origin.z));
-				ctx.vertex(Vec3(x  * r  + _origin.x, y  + _origin.y, z  * r  + _origin.z));
+				_ctx.vertex(Vec3(xp * rp + _origin.x, yp + _origin.y, zp * rp + _origin.z));
+				_ctx.vertex(Vec3(xp * r  + _origin.x, y  + _origin.y, zp * r  + _origin.z));
+				_ctx.vertex(Vec3(x  * r  + _origin.x, y  + _origin.y, z  * r  + _origin.z));
 
-				ctx.vertex(Vec3(xp * rp + _origin.x, yp + _origin.y, zp * rp + _origin.z));
-				ctx.vertex(Vec3(x  * r  + _origin.x, y  + _origin.y, z  * r  + _origin.z));
-				ctx.vertex(Vec3(x  * rp + _origin.x, yp + _origin.y, z  * rp + _origin.z));
+				_ctx.vertex(Vec3(xp * rp + _origin.x, yp + _origin.y, zp * rp + _origin.z));
+				_ctx.vertex(Vec3(x  * r  + _origin.x, y  + _origin.y, z  * r  + _origin.z));
+				_ctx.vertex(Vec3(x  * rp + _origin.x, yp + _origin.y, z  * rp + _origin.z));
 
 				xp = x;
 				zp = z;
@@ -371,108 +524,117 @@ void Im3d::DrawSphereFilled(const Vec3& _origin, float _radius, int _detail)
 			yp = y;
 			rp = r;
 		}
-	ctx.end();
+	_ctx.end();
 }
-void Im3d::DrawAlignedBox(const Vec3& _min, const Vec3& _max)
+void Im3d::DrawAlignedBox(Context& _ctx, const Vec3& _min, const Vec3& _max)
 {
-	Context& ctx = GetContext();
+	if (SkipShape(_ctx, (_min + _max) * 0.5f, Length(_max - _min) * 0.5f))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible(_min, _max))
+		if (!_ctx.isVisible(_min, _max))
 		{
 			return;
 		}
 	#endif
-	ctx.begin(PrimitiveMode_LineLoop);
-		ctx.vertex(Vec3(_min.x, _min.y, _min.z));
-		ctx.vertex(Vec3(_max.x, _min.y, _min.z));
-		ctx.vertex(Vec3(_max.x, _min.y, _max.z));
-		ctx.vertex(Vec3(_min.x, _min.y, _max.z));
-	ctx.end();
-	ctx.begin(PrimitiveMode_LineLoop);
-		ctx.vertex(Vec3(_min.x, _max.y, _min.z));
-		ctx.vertex(Vec3(_max.x, _max.y, _min.z));
-		ctx.vertex(Vec3(_max.x, _max.y, _max.z));
-		ctx.vertex(Vec3(_min.x, _max.y, _max.z));
-	ctx.end();
-	ctx.begin(PrimitiveMode_Lines);
-		ctx.vertex(Vec3(_min.x, _min.y, _min.z));
-		ctx.vertex(Vec3(_min.x, _max.y, _min.z));
-		ctx.vertex(Vec3(_max.x, _min.y, _min.z));
-		ctx.vertex(Vec3(_max.x, _max.y, _min.z));
-		ctx.vertex(Vec3(_min.x, _min.y, _max.z));
-		ctx.vertex(Vec3(_min.x, _max.y, _max.z));
-		ctx.vertex(Vec3(_max.x, _min.y, _max.z));
-		ctx.vertex(Vec3(_max.x, _max.y, _max.z));
-	ctx.end();
-}
-void Im3d::DrawAlignedBoxFilled(const Vec3& _min, const Vec3& _max)
-{
-	Context& ctx = GetContext();
+	_ctx.begin(PrimitiveMode_LineLoop);
+		_ctx.vertex(Vec3(_min.x, _min.y, _min.z));
+		_ctx.vertex(Vec3(_max.x, _min.y, _min.z));
+		_ctx.vertex(Vec3(_max.x, _min.y, _max.z));
+		_ctx.vertex(Vec3(_min.x, _min.y, _max.z));
+	_ctx.end();
+	_ctx.begin(PrimitiveMode_LineLoop);
+		_ctx.vertex(Vec3(_min.x, _max.y, _min.z));
+		_ctx.vertex(Vec3(_max.x, _max.y, _min.z));
+		_ctx.vertex(Vec3(_max.x, _max.y, _max.z));
+		_ctx.vertex(Vec3(_min.x, _max.y, _max.z));
+	_ctx.end();
+	_ctx.begin(PrimitiveMode_Lines);
+		_ctx.vertex(Vec3(_min.x, _min.y, _min.z));
+		_ctx.vertex(Vec3(_min.x, _max.y, _min.z));
+		_ctx.vertex(Vec3(_max.x, _min.y, _min.z));
+		_ctx.vertex(Vec3(_max.x, _max.y, _min.z));
+		_ctx.vertex(Vec3(_min.x, _min.y, _max.z));
+		_ctx.vertex(Vec3(_min.x, _max.y, _max.z));
+		_ctx.vertex(Vec3(_max.x, _min.y, _max.z));
+		_ctx.vertex(Vec3(_max.x, _max.y, _max.z));
+	_ctx.end();
+}
+void Im3d::DrawAlignedBoxFilled(Context& _ctx, const Vec3& _min, const Vec3& _max)
+{
+	if (SkipShape(_ctx, (_min + _max) * 0.5f, Length(_max - _min) * 0.5f))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible(_min, _max))
+		if (!_ctx.isVisible(_min, _max))
 		{
 			return;
 		}
 	#endif
 
-	ctx.pushEnableSorting(true);
+	_ctx.pushEnableSorting(true);
  // x+
-	DrawQuadFilled(
+	DrawQuadFilled(_ctx,
 		Vec3(_max.x, _max.y, _min.z),
 		Vec3(_max.x, _max.y, _max.z),
 		Vec3(_max.x, _min.y, _max.z),
 		Vec3(_max.x, _min.y, _min.z)
 		);
  // x-
-	DrawQuadFilled(
+	DrawQuadFilled(_ctx,
 		Vec3(_min.x, _min.y, _min.z),
 		Vec3(_min.x, _min.y, _max.z),
 		Vec3(_min.x, _max.y, _max.z),
 		Vec3(_min.x, _max.y, _min.z)
 		);
  // y+
-	DrawQuadFilled(
+	DrawQuadFilled(_ctx,
 		Vec3(_min.x, _max.y, _min.z),
 		Vec3(_min.x, _max.y, _max.z),
 		Vec3(_max.x, _max.y, _max.z),
 		Vec3(_max.x, _max.y, _min.z)
 		);
  // y-
-	DrawQuadFilled(
+	DrawQuadFilled(_ctx,
 		Vec3(_max.x, _min.y, _min.z),
 		Vec3(_max.x, _min.y, _max.z),
 		Vec3(_min.x, _min.y, _max.z),
 		Vec3(_min.x, _min.y, _min.z)
 		);
  // z+
-	DrawQuadFilled(
+	DrawQuadFilled(_ctx,
 		Vec3(_max.x, _min.y, _max.z),
 		Vec3(_max.x, _max.y, _max.z),
 		Vec3(_min.x, _max.y, _max.z),
 		Vec3(_min.x, _min.y, _max.z)
 		);
  // z-
-	DrawQuadFilled(
+	DrawQuadFilled(_ctx,
 		Vec3(_min.x, _min.y, _min.z),
 		Vec3(_min.x, _max.y, _min.z),
 		Vec3(_max.x, _max.y, _min.z),
 		Vec3(_max.x, _min.y, _min.z)
 		);
-	ctx.popEnableSorting();
+	_ctx.popEnableSorting();
 }
-void Im3d::DrawCylinder(const Vec3& _start, const Vec3& _end, float _radius, int _detail)
+void Im3d::DrawCylinder(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radius, int _detail)
 {
-	DrawCone2(_start, _end, _radius, _radius, _detail);
+	DrawCone2(_ctx, _start, _end, _radius, _radius, _detail);
 }
-void Im3d::DrawCylinderFilled(const Vec3& _start, const Vec3& _end, float _radius, bool _drawCapStart, bool _drawCapEnd, int _detail)
+void Im3d::DrawCylinderFilled(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radius, bool _drawCapStart, bool _drawCapEnd, int _detail)
 {
-	DrawConeFilled2(_start, _end, _radius, _radius, _drawCapStart, _drawCapEnd, _detail);
+	DrawConeFilled2(_ctx, _start, _end, _radius, _radius, _drawCapStart, _drawCapEnd, _detail);
 }
-void Im3d::DrawCapsule(const Vec3& _start, const Vec3& _end, float _radius, int _detail)
+void Im3d::DrawCapsule(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radius, int _detail)
 {
-	Context& ctx = GetContext();
+	if (SkipShape(_ctx, (_start + _end) * 0.5f, Length(_end - _start) * 0.5f + _radius))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible((_start + _end) * 0.5f, Max(Length2(_start - _end), _radius)))
+		if (!_ctx.isVisible((_start + _end) * 0.5f, Max(Length2(_start - _end), _radius)))
 		{
 			return;
 		}
@@ -481,57 +643,60 @@ void Im3d::DrawCapsule(const Vec3& _start, const Vec3& _end, float _radius, int
 	Vec3 org = _start + (_end - _start) * 0.5f;
 	if (_detail < 0)
 	{
-		_detail = ctx.estimateLevelOfDetail(org, _radius, 6, 24);
+		_detail = _ctx.estimateLevelOfDetail(org, _radius, 6, 24);
 	}
 	_detail = Max(_detail, 3);
 
 	float ln = Length(_end - _start) * 0.5f;
 	int detail2 = _detail * 2; // force cap base detail to match ends
-	ctx.pushMatrix(ctx.getMatrix() * LookAt(org, _end, ctx.getAppData().m_worldUp));
-	ctx.begin(PrimitiveMode_LineLoop);
+	_ctx.pushMatrix(_ctx.getMatrix() * LookAt(org, _end, _ctx.getAppData().m_worldUp));
+	_ctx.begin(PrimitiveMode_LineLoop);
 	 // yz silhoette + cap bases
 		for (int i = 0; i <= detail2; ++i)
 		{
 			float rad = TwoPi * ((float)i / (float)detail2) - HalfPi;
-			ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
 		}
 		for (int i = 0; i < _detail; ++i)
 		{
 			float rad = Pi * ((float)i / (float)_detail) + Pi;
-			ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(0.0f, cosf(rad), sinf(rad)) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(0.0f, cosf(rad), sinf(rad)) * _radius);
 		}
 		for (int i = 0; i < _detail; ++i)
 		{
 			float rad = Pi * ((float)i / (float)_detail);
-			ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(0.0f, cosf(rad), sinf(rad)) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(0.0f, cosf(rad), sinf(rad)) * _radius);
 		}
 		for (int i = 0; i <= detail2; ++i)
 		{
 			float rad = TwoPi * ((float)i / (float)detail2) - HalfPi;
-			ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
 		}
-	ctx.end();
-	ctx.begin(PrimitiveMode_LineLoop);
+	_ctx.end();
+	_ctx.begin(PrimitiveMode_LineLoop);
 	 // xz silhoette
 		for (int i = 0; i < _detail; ++i)
 		{
 			float rad = Pi * ((float)i / (float)_detail) + Pi;
-			ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), 0.0f, sinf(rad)) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), 0.0f, sinf(rad)) * _radius);
 		}
 		for (int i = 0; i < _detail; ++i)
 		{
 			float rad = Pi * ((float)i / (float)_detail);
-			ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), 0.0f, sinf(rad)) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), 0.0f, sinf(rad)) * _radius);
 		}
-	ctx.end();
-	ctx.popMatrix();
+	_ctx.end();
+	_ctx.popMatrix();
 }
-void Im3d::DrawPrism(const Vec3& _start, const Vec3& _end, float _radius, int _sides)
+void Im3d::DrawPrism(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radius, int _sides)
 {
 	_sides = Max(_sides, 2);
-	Context& ctx = GetContext();
+	if (SkipShape(_ctx, (_start + _end) * 0.5f, Length(_end - _start) * 0.5f + _radius))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible((_start + _end) * 0.5f, Max(Length2(_start - _end), _radius)))
+		if (!_ctx.isVisible((_start + _end) * 0.5f, Max(Length2(_start - _end), _radius)))
 		{
 			return;
 		}
@@ -539,60 +704,62 @@ void Im3d::DrawPrism(const Vec3& _start, const Vec3& _end, float _radius, int _s
 
 	Vec3 org  = _start + (_end - _start) * 0.5f;
 	float ln  = Length(_end - _start) * 0.5f;
-	ctx.pushMatrix(ctx.getMatrix() * LookAt(org, _end, ctx.getAppData().m_worldUp));
-	ctx.begin(PrimitiveMode_LineLoop);
+	_ctx.pushMatrix(_ctx.getMatrix() * LookAt(org, _end, _ctx.getAppData().m_worldUp));
+	_ctx.begin(PrimitiveMode_LineLoop);
 		for (int i = 0; i <= _sides; ++i)
 		{
 			float rad = TwoPi * ((float)i / (float)_sides) - HalfPi;
-			ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
 		}
 		for (int i = 0; i <= _sides; ++i)
 		{
 			float rad = TwoPi * ((float)i / (float)_sides) - HalfPi;
-			ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
 		}
-	ctx.end();
-	ctx.begin(PrimitiveMode_Lines);
+	_ctx.end();
+	_ctx.begin(PrimitiveMode_Lines);
 		for (int i = 0; i <= _sides; ++i)
 		{
 			float rad = TwoPi * ((float)i / (float)_sides) - HalfPi;
-			ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
-			ctx.vertex(Vec3(0.0f, 0.0f,  ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
+			_ctx.vertex(Vec3(0.0f, 0.0f,  ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radius);
 		}
-	ctx.end();
-	ctx.popMatrix();
+	_ctx.end();
+	_ctx.popMatrix();
 }
-void Im3d::DrawArrow(const Vec3& _start, const Vec3& _end, float _headLength, float _headThickness)
+void Im3d::DrawArrow(Context& _ctx, const Vec3& _start, const Vec3& _end, float _headLength, float _headThickness)
 {
-	Context& ctx = GetContext();
 
 	if (_headThickness < 0.0f)
 	{
-		_headThickness = ctx.getSize() * 2.0f;
+		_headThickness = _ctx.getSize() * 2.0f;
 	}
 
 	Vec3 dir = _end - _start;
 	float dirlen = Length(dir);
 	if (_headLength < 0.0f)
 	{
-		_headLength = Min(dirlen / 2.0f, ctx.pixelsToWorldSize(_end, _headThickness * 2.0f));
+		_headLength = Min(dirlen / 2.0f, _ctx.pixelsToWorldSize(_end, _headThickness * 2.0f));
 	}
 	dir = dir / dirlen;
 
 	Vec3 head = _end - dir * _headLength;
-	ctx.begin(PrimitiveMode_Lines);
-		ctx.vertex(_start);
-		ctx.vertex(head);
-		ctx.vertex(head, _headThickness, ctx.getColor());
-		ctx.vertex(_end, 2.0f, ctx.getColor()); // \hack \todo 2.0f here compensates for the shader antialiasing (which reduces alpha when size < 2)
-	ctx.end();
+	_ctx.begin(PrimitiveMode_Lines);
+		_ctx.vertex(_start);
+		_ctx.vertex(head);
+		_ctx.vertex(head, _headThickness, _ctx.getColor());
+		_ctx.vertex(_end, 2.0f, _ctx.getColor()); // \hack \todo 2.0f here compensates for the shader antialiasing (which reduces alpha when size < 2)
+	_ctx.end();
 }
-void Im3d::DrawCone2(const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, int _detail)
+void Im3d::DrawCone2(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, int _detail)
 {
-	Context& ctx = GetContext();
 	const float maxRadius = Max(_radiusStart, _radiusEnd);
+	if (SkipShape(_ctx, (_start + _end) * 0.5f, Length(_end - _start) * 0.5f + maxRadius))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible((_start + _end) * 0.5f, Max(Length2(_start - _end), maxRadius)))
+		if (!_ctx.isVisible((_start + _end) * 0.5f, Max(Length2(_start - _end), maxRadius)))
 		{
 			return;
 		}
@@ -601,55 +768,58 @@ void Im3d::DrawCone2(const Vec3& _start, const Vec3& _end, float _radiusStart, f
 	const Vec3 org  = _start + (_end - _start) * 0.5f;
 	if (_detail < 0)
 	{
-		_detail = ctx.estimateLevelOfDetail(org, maxRadius, 16, 24);
+		_detail = _ctx.estimateLevelOfDetail(org, maxRadius, 16, 24);
 	}
 	_detail = Max(_detail, 3);
 
 	const float ln  = Length(_end - _start) * 0.5f;
-	ctx.pushMatrix(ctx.getMatrix() * LookAt(org, _end, ctx.getAppData().m_worldUp));
+	_ctx.pushMatrix(_ctx.getMatrix() * LookAt(org, _end, _ctx.getAppData().m_worldUp));
 
 	// Start cap.
 	if (_radiusStart > 0.0f)
 	{
-		ctx.begin(PrimitiveMode_LineLoop);
+		_ctx.begin(PrimitiveMode_LineLoop);
 			for (int i = 0; i <= _detail; ++i)
 			{
 				const float rad = TwoPi * ((float)i / (float)_detail) - HalfPi;
-				ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusStart);
+				_ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusStart);
 			}
-		ctx.end();
+		_ctx.end();
 	}
 
 	// End cap.
 	if (_radiusEnd > 0.0f)
 	{
-		ctx.begin(PrimitiveMode_LineLoop);
+		_ctx.begin(PrimitiveMode_LineLoop);
 			for (int i = 0; i <= _detail; ++i)
 			{
 				const float rad = TwoPi * ((float)i / (float)_detail) - HalfPi;
-				ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusEnd);
+				_ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusEnd);
 			}
-		ctx.end();
+		_ctx.end();
 	}
 
 	// Sides.
-	ctx.begin(PrimitiveMode_Lines);
+	_ctx.begin(PrimitiveMode_Lines);
 		for (int i = 0; i <= _detail; ++i)
 		{
 			const float rad = TwoPi * ((float)i / (float)_detail) - HalfPi;
-			ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusStart);
-			ctx.vertex(Vec3(0.0f, 0.0f,  ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusEnd);
+			_ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusStart);
+			_ctx.vertex(Vec3(0.0f, 0.0f,  ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusEnd);
 		}
-	ctx.end();
+	_ctx.end();
 
-	ctx.popMatrix();
+	_ctx.popMatrix();
 }
-void Im3d::DrawConeFilled2(const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, bool _drawCapStart, bool _drawCapEnd, int _detail)
+void Im3d::DrawConeFilled2(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, bool _drawCapStart, bool _drawCapEnd, int _detail)
 {
-	Context& ctx = GetContext();
 	const float maxRadius = Max(_radiusStart, _radiusEnd);
+	if (SkipShape(_ctx, (_start + _end) * 0.5f, Length(_end - _start) * 0.5f + maxRadius))
+	{
+		return;
+	}
 	#if IM3D_CULL_PRIMITIVES
-		if (!ctx.isVisible((_start + _end) * 0.5f, Max(Length2(_start - _end), maxRadius)))
+		if (!_ctx.isVisible((_start + _end) * 0.5f, Max(Length2(_start - _end), maxRadius)))
 		{
 			return;
 		}
@@ -659,61 +829,64 @@ void Im3d::DrawConeFilled2(const Vec3& _start, const Vec3& _end, float _radiusSt
 	const Vec3 org  = _start + (_end - _start) * 0.5f;
 	if (_detail < 0)
 	{
-		_detail = ctx.estimateLevelOfDetail(org, maxRadius, 16, 24);
+		_detail = _ctx.estimateLevelOfDetail(org, maxRadius, 16, 24);
 	}
 	_detail = Max(_detail, 3);
 
 	const float ln  = Length(_end - _start) * 0.5f;
-	ctx.pushMatrix(ctx.getMatrix() * LookAt(org, _end, ctx.getAppData().m_worldUp));
-	ctx.pushEnableSorting(true);
+	_ctx.pushMatrix(_ctx.getMatrix() * LookAt(org, _end, _ctx.getAppData().m_worldUp));
+	_ctx.pushEnableSorting(true);
 
 	
 	// Start cap.
 	if (_drawCapStart && _radiusStart > 0.0f)
 	{
-		ctx.begin(PrimitiveMode_TriangleStrip);
+		_ctx.begin(PrimitiveMode_TriangleStrip);
 			for (int i = 0; i <= _detail; ++i)
 			{
 				const float rad = TwoPi * ((float)i / (float)_detail) - HalfPi;
-				ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusStart);
-				ctx.vertex(Vec3(0.0f, 0.0f, -ln));
+				_ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusStart);
+				_ctx.vertex(Vec3(0.0f, 0.0f, -ln));
 			}
-		ctx.end();
+		_ctx.end();
 	}
 
 	// End cap.
 	if (_drawCapEnd && _radiusEnd > 0.0f)
 	{
-		ctx.begin(PrimitiveMode_TriangleStrip);
+		_ctx.begin(PrimitiveMode_TriangleStrip);
 			for (int i = 0; i <= _detail; ++i)
 			{
 				const float rad = TwoPi * ((float)i / (float)_detail) - HalfPi;
-				ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusEnd);
-				ctx.vertex(Vec3(0.0f, 0.0f, ln));
+				_ctx.vertex(Vec3(0.0f, 0.0f, ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusEnd);
+				_ctx.vertex(Vec3(0.0f, 0.0f, ln));
 			}
-		ctx.end();
+		_ctx.end();
 	}
 
 	// Sides.
-	ctx.begin(PrimitiveMode_TriangleStrip);
+	_ctx.begin(PrimitiveMode_TriangleStrip);
 		for (int i = 0; i <= _detail; ++i)
 		{
 			const float rad = TwoPi * ((float)i / (float)_detail) - HalfPi;
-			ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusStart);
-			ctx.vertex(Vec3(0.0f, 0.0f,  ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusEnd);
+			_ctx.vertex(Vec3(0.0f, 0.0f, -ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusStart);
+			_ctx.vertex(Vec3(0.0f, 0.0f,  ln) + Vec3(cosf(rad), sinf(rad), 0.0f) * _radiusEnd);
 		}
-	ctx.end();
+	_ctx.end();
 
-	ctx.popEnableSorting();
-	ctx.popMatrix();
+	_ctx.popEnableSorting();
+	_ctx.popMatrix();
 }
 
 #if IM3D_USE_DEPRECATED_DRAW_CONE
-void Im3d::DrawCone(const Vec3& _origin, const Vec3& _normal, float height, float _radius, int _detail){
+void Im3d::DrawCone(Context& _ctx, const Vec3& _origin, const Vec3& _normal, float height, float _radius, int _detail){
 
-    Context& ctx = GetContext();
+    if (SkipShape(_ctx, _origin + _normal * height / 2, Max(height / 2, _radius)))
+    {
+        return;
+    }
     #if IM3D_CULL_PRIMITIVES
-        if (!ctx.isVisible(_origin + _normal * height / 2, height / 2))
+        if (!_ctx.isVisible(_origin + _normal * height / 2, height / 2))
         {
             return;
         }
@@ -722,37 +895,40 @@ void Im3d::DrawCone(const Vec3& _origin, const Vec3& _normal, float height, floa
 
     if (_detail < 0)
     {
-        _detail = ctx.estimateLevelOfDetail(_origin + _normal * height / 2, height / 2, 8, 48);
+        _detail = _ctx.estimateLevelOfDetail(_origin + _normal * height / 2, height / 2, 8, 48);
     }
     _detail = Max(_detail, 3);
 
     //cone bottom face
-    DrawCircle(_origin,_normal,_radius,_detail);
+    DrawCircle(_ctx, _origin,_normal,_radius,_detail);
 
     //cone side face
-    ctx.pushMatrix(ctx.getMatrix() * LookAt(_origin, _origin + _normal, ctx.getAppData().m_worldUp));
-    ctx.begin(PrimitiveMode_LineLoop);
+    _ctx.pushMatrix(_ctx.getMatrix() * LookAt(_origin, _origin + _normal, _ctx.getAppData().m_worldUp));
+    _ctx.begin(PrimitiveMode_LineLoop);
         float cp = _radius;
         float sp = 0.0f;
         for (int i = 1; i <= _detail; ++i)
         {
-            ctx.vertex(Vec3(0,0,1)*height);
-            ctx.vertex(Vec3(cp, sp, 0.0f));
+            _ctx.vertex(Vec3(0,0,1)*height);
+            _ctx.vertex(Vec3(cp, sp, 0.0f));
             float rad = TwoPi * ((float)i / (float)_detail);
             float c = cosf(rad) * _radius;
             float s = sinf(rad) * _radius;
-            ctx.vertex(Vec3(c, s, 0.0f));
+            _ctx.vertex(Vec3(c, s, 0.0f));
             cp = c;
             sp = s;
         }
-    ctx.end();
-    ctx.popMatrix();
+    _ctx.end();
+    _ctx.popMatrix();
 }
-void Im3d::DrawConeFilled(const Vec3& _origin, const Vec3& _normal, float height, float _radius, int _detail){
+void Im3d::DrawConeFilled(Context& _ctx, const Vec3& _origin, const Vec3& _normal, float height, float _radius, int _detail){
 
-    Context& ctx = GetContext();
+    if (SkipShape(_ctx, _origin + _normal * height / 2, Max(height / 2, _radius)))
+    {
+        return;
+    }
     #if IM3D_CULL_PRIMITIVES
-        if (!ctx.isVisible(_origin + _normal * height / 2, height / 2))
+        if (!_ctx.isVisible(_origin + _normal * height / 2, height / 2))
         {
             return;
         }
@@ -761,39 +937,40 @@ void Im3d::DrawConeFilled(const Vec3& _origin, const Vec3& _normal, float height
 
     if (_detail < 0)
     {
-        _detail = ctx.estimateLevelOfDetail(_origin + _normal * height / 2, height / 2, 8, 48);
+        _detail = _ctx.estimateLevelOfDetail(_origin + _normal * height / 2, height / 2, 8, 48);
     }
     _detail = Max(_detail, 3);
 
     //cone bottom face
-    DrawCircleFilled(_origin,_normal,_radius,_detail);
+    DrawCircleFilled(_ctx, _origin,_normal,_radius,_detail);
 
     //cone side face
-    ctx.pushMatrix(ctx.getMatrix() * LookAt(_origin, _origin + _normal, ctx.getAppData().m_worldUp));
-    ctx.begin(PrimitiveMode_Triangles);
+    _ctx.pushMatrix(_ctx.getMatrix() * LookAt(_origin, _origin + _normal, _ctx.getAppData().m_worldUp));
+    _ctx.begin(PrimitiveMode_Triangles);
         float cp = _radius;
         float sp = 0.0f;
         for (int i = 1; i <= _detail; ++i)
         {
-            ctx.vertex(Vec3(0,0,1)*height);
-            ctx.vertex(Vec3(cp, sp, 0.0f));
+            _ctx.vertex(Vec3(0,0,1)*height);
+            _ctx.vertex(Vec3(cp, sp, 0.0f));
             float rad = TwoPi * ((float)i / (float)_detail);
             float c = cosf(rad) * _radius;
             float s = sinf(rad) * _radius;
-            ctx.vertex(Vec3(c, s, 0.0f));
+            _ctx.vertex(Vec3(c, s, 0.0f));
             cp = c;
             sp = s;
         }
-    ctx.end();
-    ctx.popMatrix();
+    _ctx.end();
+    _ctx.popMatrix();
 }
 #endif // IM3D_USE_DEPRECATED_DRAW_CONE
 
 void Im3d::Text(const Vec3& _position, U32 _textFlags, const char* _text, ...)
 {
+	Context& ctx = GetContext();
 	va_list args;
 	va_start(args, _text);
-	GetContext().text(_position, GetSize(), GetColor(), (TextFlags)_textFlags, _text, args);
+	ctx.text(_position, ctx.getSize(), ctx.getColor(), (TextFlags)_textFlags, _text, args);
 	va_end(args);
 }
 
@@ -805,8 +982,33 @@ void Im3d::Text(const Vec3& _position, float _size, Color _color, U32 _textFlags
 	va_end(args);
 }
 
+void Im3d::Text(Context& _ctx, const Vec3& _position, U32 _textFlags, const char* _text, ...)
+{
+	va_list args;
+	va_start(args, _text);
+	_ctx.text(_position, _ctx.getSize(), _ctx.getColor(), (TextFlags)_textFlags, _text, args);
+	va_end(args);
+}
+
+void Im3d::Text(Context& _ctx, const Vec3& _position, float _size, Color _color, U32 _textFlags, const char* _text, ...)
+{
+	va_list args;
+	va_start(args, _text);
+	_ctx.text(_position, _size, _color, (TextFlags)_textFlags, _text, args);
+	va_end(args);
+}
+
+void Im3d::TextUnformatted(Context& _ctx, const Vec3& _position, U32 _textFlags, const char* _textStart, const char* _textEnd)
+{
+	_ctx.text(_position, _ctx.getSize(), _ctx.getColor(), (TextFlags)_textFlags, _textStart, _textEnd ? _textEnd : _textStart + strlen(_textStart));
+}
+
+void Im3d::TextUnformatted(Context& _ctx, const Vec3& _position, float _size, Color _color, U32 _textFlags, const char* _textStart, const char* _textEnd)
+{
+	_ctx.text(_position, _size, _color, (TextFlags)_textFlags, _textStart, _textEnd ? _textEnd : _textStart + strlen(_textStart));
+}
+
 
-static constexpr U32 kFnv1aPrime32 = 0x01000193u;
 static U32 Hash(const char* _buf, int _buflen, U32 _base)
 {
 	U32 ret = _base;
@@ -814,7 +1016,7 @@ static U32 Hash(const char* _buf, int _buflen, U32 _base)
 	while (_buf < lim)
 	{
 		ret ^= (U32)*_buf++;
-		ret *= kFnv1aPrime32;
+		ret *= internal::kFnv1aPrime32;
 	}
 	return ret;
 }
@@ -824,21 +1026,21 @@ static U32 HashStr(const char* _str, U32 _base)
 	while (*_str)
 	{
 		ret ^= (U32)*_str++;
-		ret *= kFnv1aPrime32;
+		ret *= internal::kFnv1aPrime32;
 	}
 	return ret;
 }
-Im3d::Id Im3d::MakeId(const char* _str)
+Im3d::Id Im3d::MakeId(Context& _ctx, const char* _str)
 {
-	return HashStr(_str, GetContext().getId());
+	return HashStr(_str, _ctx.getId());
 }
-Im3d::Id Im3d::MakeId(const void* _ptr)
+Im3d::Id Im3d::MakeId(Context& _ctx, const void* _ptr)
 {
-	return Hash((const char*)&_ptr, sizeof(void*), GetContext().getId());
+	return Hash((const char*)&_ptr, sizeof(void*), _ctx.getId());
 }
-Im3d::Id Im3d::MakeId(int _i)
+Im3d::Id Im3d::MakeId(Context& _ctx, int _i)
 {
-	return Hash((const char*)&_i, sizeof(int), GetContext().getId());
+	return Hash((const char*)&_i, sizeof(int), _ctx.getId());
 }
 
 inline static float Snap(float _val, float _snap)
@@ -893,52 +1095,51 @@ inline static Vec3 Snap(const Vec3& _pos, const Plane& _plane, float _snap)
 	return _pos;
 }
 
-bool Im3d::GizmoTranslation(Id _id, float _translation_[3], bool _local)
+bool Im3d::GizmoTranslation(Context& _ctx, Id _id, float _translation_[3], bool _local)
 {
-	Context& ctx = GetContext();
 
 	bool ret = false;
 	Vec3* outVec3 = (Vec3*)_translation_;
 	Vec3 drawAt = *outVec3;
-	const AppData& appData = ctx.getAppData();
+	const AppData& appData = _ctx.getAppData();
 
-	float worldHeight = ctx.pixelsToWorldSize(drawAt, ctx.m_gizmoHeightPixels);
+	float worldHeight = _ctx.pixelsToWorldSize(drawAt, _ctx.m_gizmoHeightPixels);
 	#if IM3D_CULL_GIZMOS
-		if (!ctx.isVisible(drawAt, worldHeight))
+		if (!_ctx.isVisible(drawAt, worldHeight))
 		{
 			return false;
 		}
 	#endif
 
-	ctx.pushId(_id);
-	ctx.m_appId = _id;
+	_ctx.pushId(_id);
+	_ctx.m_appId = _id;
 
 	if (_local)
 	{
-		Mat4 localMatrix = ctx.getMatrix();
+		Mat4 localMatrix = _ctx.getMatrix();
 		localMatrix.setScale(Vec3(1.0f));
-		ctx.pushMatrix(localMatrix);
+		_ctx.pushMatrix(localMatrix);
 	}
 
 	float planeSize = worldHeight * (0.5f * 0.5f);
 	float planeOffset = worldHeight * 0.5f;
-	float worldSize = ctx.pixelsToWorldSize(drawAt, ctx.m_gizmoSizePixels);
+	float worldSize = _ctx.pixelsToWorldSize(drawAt, _ctx.m_gizmoSizePixels);
 
 	struct AxisG { Id m_id; Vec3 m_axis; Color m_color; };
 	AxisG axes[] =
 		{
-			{ MakeId("axisX"), Vec3(1.0f, 0.0f, 0.0f), Color_Red   },
-			{ MakeId("axisY"), Vec3(0.0f, 1.0f, 0.0f), Color_Green },
-			{ MakeId("axisZ"), Vec3(0.0f, 0.0f, 1.0f), Color_Blue  }
+			{ MakeId(_ctx, IM3D_STATIC_ID("axisX")), Vec3(1.0f, 0.0f, 0.0f), Color_Red   },
+			{ MakeId(_ctx, IM3D_STATIC_ID("axisY")), Vec3(0.0f, 1.0f, 0.0f), Color_Green },
+			{ MakeId(_ctx, IM3D_STATIC_ID("axisZ")), Vec3(0.0f, 0.0f, 1.0f), Color_Blue  }
 		};
 	struct PlaneG { Id m_id; Vec3 m_origin; };
 
 	PlaneG planes[] =
 		{
-			{ MakeId("planeYZ"), Vec3(0.0f, planeOffset, planeOffset) },
-			{ MakeId("planeXZ"), Vec3(planeOffset, 0.0f, planeOffset) },
-			{ MakeId("planeXY"), Vec3(planeOffset, planeOffset, 0.0f) },
-			{ MakeId("planeV"),  Vec3(0.0f, 0.0f, 0.0f) }
+			{ MakeId(_ctx, IM3D_STATIC_ID("planeYZ")), Vec3(0.0f, planeOffset, planeOffset) },
+			{ MakeId(_ctx, IM3D_STATIC_ID("planeXZ")), Vec3(planeOffset, 0.0f, planeOffset) },
+			{ MakeId(_ctx, IM3D_STATIC_ID("planeXY")), Vec3(planeOffset, planeOffset, 0.0f) },
+			{ MakeId(_ctx, IM3D_STATIC_ID("planeV")),  Vec3(0.0f, 0.0f, 0.0f) }
 		};
 
  // invert axes if viewing from behind
@@ -950,7 +1151,7 @@ bool Im3d::GizmoTranslation(Id _id, float _translation_[3], bool _local)
 			;
 		for (int i = 0; i < 3; ++i)
 		{
-			const Vec3 axis = _local ? Vec3(ctx.getMatrix().getCol(i)) : axes[i].m_axis;
+			const Vec3 axis = _local ? Vec3(_ctx.getMatrix().getCol(i)) : axes[i].m_axis;
 			if (Dot(axis, viewDir) < 0.0f)
 			{
 				axes[i].m_axis = -axes[i].m_axis;
@@ -964,250 +1165,248 @@ bool Im3d::GizmoTranslation(Id _id, float _translation_[3], bool _local)
 
  	Sphere boundingSphere(*outVec3, worldHeight * 1.5f); // expand the bs to catch the planar subgizmos
 	Ray ray(appData.m_cursorRayOrigin, appData.m_cursorRayDirection);
-	bool intersects = ctx.m_appHotId == ctx.m_appId || Intersects(ray, boundingSphere);
+	bool intersects = _ctx.m_appHotId == _ctx.m_appId || Intersects(ray, boundingSphere);
 
  // planes
 	#ifdef IM3D_GIZMO_LAYER_ID
-		ctx.pushLayerId(IM3D_GIZMO_LAYER_ID);
+		_ctx.pushLayerId(IM3D_GIZMO_LAYER_ID);
 	#endif
- 	ctx.pushEnableSorting(true);
+ 	_ctx.pushEnableSorting(true);
 	if (_local)
 	{
 	 // local planes need to be drawn with the pushed matrix for correct orientation
 		for (int i = 0; i < 3; ++i)
 		{
 			const PlaneG& plane = planes[i];
-			ctx.gizmoPlaneTranslation_Draw(plane.m_id, plane.m_origin, axes[i].m_axis, planeSize, Color_GizmoHighlight);
-			axes[i].m_axis = Mat3(ctx.getMatrix()) * axes[i].m_axis;
+			_ctx.gizmoPlaneTranslation_Draw(plane.m_id, plane.m_origin, axes[i].m_axis, planeSize, Color_GizmoHighlight);
+			axes[i].m_axis = Mat3(_ctx.getMatrix()) * axes[i].m_axis;
 			if (intersects)
 			{
-				ret |= ctx.gizmoPlaneTranslation_Behavior(plane.m_id, ctx.getMatrix() * plane.m_origin, axes[i].m_axis, appData.m_snapTranslation, planeSize, outVec3);
+				ret |= _ctx.gizmoPlaneTranslation_Behavior(plane.m_id, _ctx.getMatrix() * plane.m_origin, axes[i].m_axis, appData.m_snapTranslation, planeSize, outVec3);
 			}
 		}
 	}
 	else
 	{
-		ctx.pushMatrix(Mat4(1.0f));
+		_ctx.pushMatrix(Mat4(1.0f));
 		for (int i = 0; i < 3; ++i)
 		{
 			const PlaneG& plane = planes[i];
-			ctx.gizmoPlaneTranslation_Draw(plane.m_id, drawAt + plane.m_origin, axes[i].m_axis, planeSize, Color_GizmoHighlight);
+			_ctx.gizmoPlaneTranslation_Draw(plane.m_id, drawAt + plane.m_origin, axes[i].m_axis, planeSize, Color_GizmoHighlight);
 			if (intersects)
 			{
-				ret |= ctx.gizmoPlaneTranslation_Behavior(plane.m_id, drawAt + plane.m_origin, axes[i].m_axis, appData.m_snapTranslation, planeSize, outVec3);
+				ret |= _ctx.gizmoPlaneTranslation_Behavior(plane.m_id, drawAt + plane.m_origin, axes[i].m_axis, appData.m_snapTranslation, planeSize, outVec3);
 			}
 		}
-		ctx.popMatrix();
+		_ctx.popMatrix();
 	}
 
-	ctx.pushMatrix(Mat4(1.0f));
+	_ctx.pushMatrix(Mat4(1.0f));
 
 	if (intersects)
 	{
 	 // view plane (store the normal when the gizmo becomes active)
-		Id currentId = ctx.m_activeId;
-		Vec3& storedViewNormal= *((Vec3*)ctx.m_gizmoStateMat3.m);
+		Id currentId = _ctx.m_activeId;
+		Vec3& storedViewNormal= *((Vec3*)_ctx.m_gizmoStateMat3.m);
 		Vec3 viewNormal;
-		if (planes[3].m_id == ctx.m_activeId)
+		if (planes[3].m_id == _ctx.m_activeId)
 		{
 			viewNormal = storedViewNormal;
 		}
 		else
 		{
-			viewNormal = ctx.getAppData().m_viewDirection;
+			viewNormal = _ctx.getAppData().m_viewDirection;
 		}
-		ret |= ctx.gizmoPlaneTranslation_Behavior(planes[3].m_id, drawAt, viewNormal, appData.m_snapTranslation, worldSize, outVec3);
-		if (currentId != ctx.m_activeId)
+		ret |= _ctx.gizmoPlaneTranslation_Behavior(planes[3].m_id, drawAt, viewNormal, appData.m_snapTranslation, worldSize, outVec3);
+		if (currentId != _ctx.m_activeId)
 		{
 		 // gizmo became active, store the view normal
 			storedViewNormal = viewNormal;
 		}
 
 	 // highlight axes if the corresponding plane is hot
-		if (planes[0].m_id == ctx.m_hotId) // YZ
+		if (planes[0].m_id == _ctx.m_hotId) // YZ
 		{
 			axes[1].m_color = axes[2].m_color = Color_GizmoHighlight;
 		}
-		else if (planes[1].m_id == ctx.m_hotId) // XZ
+		else if (planes[1].m_id == _ctx.m_hotId) // XZ
 		{
 			axes[0].m_color = axes[2].m_color = Color_GizmoHighlight;
 		}
-		else if (planes[2].m_id == ctx.m_hotId) // XY
+		else if (planes[2].m_id == _ctx.m_hotId) // XY
 		{
 			axes[0].m_color = axes[1].m_color = Color_GizmoHighlight;
 		}
-		else if (planes[3].m_id == ctx.m_hotId) // view plane
+		else if (planes[3].m_id == _ctx.m_hotId) // view plane
 		{
 			axes[0].m_color = axes[1].m_color = axes[2].m_color = Color_GizmoHighlight;
 		}
 	}
  // draw the view plane handle
-	ctx.begin(PrimitiveMode_Points);
-		ctx.vertex(drawAt, ctx.m_gizmoSizePixels * 2.0f, planes[3].m_id == ctx.m_hotId ? Color_GizmoHighlight : Color_White);
-	ctx.end();
+	_ctx.begin(PrimitiveMode_Points);
+		_ctx.vertex(drawAt, _ctx.m_gizmoSizePixels * 2.0f, planes[3].m_id == _ctx.m_hotId ? Color_GizmoHighlight : Color_White);
+	_ctx.end();
 
  // axes
 	for (int i = 0; i < 3; ++i)
 	{
 		AxisG& axis = axes[i];
-		ctx.gizmoAxisTranslation_Draw(axis.m_id, drawAt, axis.m_axis, worldHeight, worldSize, axis.m_color);
+		_ctx.gizmoAxisTranslation_Draw(axis.m_id, drawAt, axis.m_axis, worldHeight, worldSize, axis.m_color);
 		if (intersects)
 		{
-			ret |= ctx.gizmoAxisTranslation_Behavior(axis.m_id, drawAt, axis.m_axis, appData.m_snapTranslation, worldHeight, worldSize, outVec3);
+			ret |= _ctx.gizmoAxisTranslation_Behavior(axis.m_id, drawAt, axis.m_axis, appData.m_snapTranslation, worldHeight, worldSize, outVec3);
 		}
 	}
-	ctx.popMatrix();
-	ctx.popEnableSorting();
+	_ctx.popMatrix();
+	_ctx.popEnableSorting();
 	#ifdef IM3D_GIZMO_LAYER_ID
-		ctx.popLayerId();
+		_ctx.popLayerId();
 	#endif
 
 	if (_local)
 	{
-		ctx.popMatrix();
+		_ctx.popMatrix();
 	}
 
-	ctx.popId();
+	_ctx.popId();
 
 	return ret;
 }
 
-bool Im3d::GizmoRotation(Id _id, float _rotation_[3*3], bool _local)
+bool Im3d::GizmoRotation(Context& _ctx, Id _id, float _rotation_[3*3], bool _local)
 {
-	Context& ctx = GetContext();
 
-	Vec3 origin = ctx.getMatrix().getTranslation();
-	float worldRadius = ctx.pixelsToWorldSize(origin, ctx.m_gizmoHeightPixels);
+	Vec3 origin = _ctx.getMatrix().getTranslation();
+	float worldRadius = _ctx.pixelsToWorldSize(origin, _ctx.m_gizmoHeightPixels);
 	#if IM3D_CULL_GIZMOS
-		if (!ctx.isVisible(origin, worldRadius))
+		if (!_ctx.isVisible(origin, worldRadius))
 		{
 			return false;
 		}
 	#endif
 
-	Id currentId = ctx.m_activeId; // store currentId to detect if the gizmo becomes active during this call
-	ctx.pushId(_id);
-	ctx.m_appId = _id;
+	Id currentId = _ctx.m_activeId; // store currentId to detect if the gizmo becomes active during this call
+	_ctx.pushId(_id);
+	_ctx.m_appId = _id;
 
 	bool ret = false;
-	Mat3& storedRotation = ctx.m_gizmoStateMat3;
+	Mat3& storedRotation = _ctx.m_gizmoStateMat3;
 	Mat3* outMat3 = (Mat3*)_rotation_;
 	Vec3 euler = ToEulerXYZ(*outMat3);
-	float worldSize = ctx.pixelsToWorldSize(origin, ctx.m_gizmoSizePixels);
+	float worldSize = _ctx.pixelsToWorldSize(origin, _ctx.m_gizmoSizePixels);
 
 	struct AxisG { Id m_id; Vec3 m_axis; Color m_color; };
 	AxisG axes[] =
 		{
-			{ MakeId("axisX"), Vec3(1.0f, 0.0f, 0.0f), Color_Red   },
-			{ MakeId("axisY"), Vec3(0.0f, 1.0f, 0.0f), Color_Green },
-			{ MakeId("axisZ"), Vec3(0.0f, 0.0f, 1.0f), Color_Blue  }
+			{ MakeId(_ctx, IM3D_STATIC_ID("axisX")), Vec3(1.0f, 0.0f, 0.0f), Color_Red   },
+			{ MakeId(_ctx, IM3D_STATIC_ID("axisY")), Vec3(0.0f, 1.0f, 0.0f), Color_Green },
+			{ MakeId(_ctx, IM3D_STATIC_ID("axisZ")), Vec3(0.0f, 0.0f, 1.0f), Color_Blue  }
 		};
-	Id viewId = MakeId("axisV");
+	Id viewId = MakeId(_ctx, IM3D_STATIC_ID("axisV"));
 
 	Sphere boundingSphere(origin, worldRadius);
-	Ray ray(ctx.getAppData().m_cursorRayOrigin, ctx.getAppData().m_cursorRayDirection);
-	bool intersects = ctx.m_appHotId == ctx.m_appId || Intersects(ray, boundingSphere);
+	Ray ray(_ctx.getAppData().m_cursorRayOrigin, _ctx.getAppData().m_cursorRayDirection);
+	bool intersects = _ctx.m_appHotId == _ctx.m_appId || Intersects(ray, boundingSphere);
 
-	const AppData& appData = ctx.getAppData();
+	const AppData& appData = _ctx.getAppData();
 
 	if (_local)
 	{
 	 // extract axes from the pushed matrix
 		for (int i = 0; i < 3; ++i)
 		{
-			if (ctx.m_activeId == axes[i].m_id)
+			if (_ctx.m_activeId == axes[i].m_id)
 			{
 			 // use the stored matrix where the id is active, avoid rotating the axis frame during interaction (cause numerical instability)
 				axes[i].m_axis = Normalize(Vec3(storedRotation.getCol(i)));
 			}
 			else
 			{
-				axes[i].m_axis = Normalize(Vec3(ctx.getMatrix().getCol(i)));
+				axes[i].m_axis = Normalize(Vec3(_ctx.getMatrix().getCol(i)));
 			}
 		}
 	}
 
 	#ifdef IM3D_GIZMO_LAYER_ID
-		ctx.pushLayerId(IM3D_GIZMO_LAYER_ID);
+		_ctx.pushLayerId(IM3D_GIZMO_LAYER_ID);
 	#endif
-	ctx.pushMatrix(Mat4(1.0f));
+	_ctx.pushMatrix(Mat4(1.0f));
 	for (int i = 0; i < 3; ++i)
 	{
-		if (i == 0 && (ctx.m_activeId == axes[1].m_id || ctx.m_activeId == axes[2].m_id || ctx.m_activeId == viewId))
+		if (i == 0 && (_ctx.m_activeId == axes[1].m_id || _ctx.m_activeId == axes[2].m_id || _ctx.m_activeId == viewId))
 		{
 			continue;
 		}
-		if (i == 1 && (ctx.m_activeId == axes[2].m_id || ctx.m_activeId == axes[0].m_id || ctx.m_activeId == viewId))
+		if (i == 1 && (_ctx.m_activeId == axes[2].m_id || _ctx.m_activeId == axes[0].m_id || _ctx.m_activeId == viewId))
 		{
 			continue;
 		}
-		if (i == 2 && (ctx.m_activeId == axes[0].m_id || ctx.m_activeId == axes[1].m_id || ctx.m_activeId == viewId))
+		if (i == 2 && (_ctx.m_activeId == axes[0].m_id || _ctx.m_activeId == axes[1].m_id || _ctx.m_activeId == viewId))
 		{
 			continue;
 		}
 
 		AxisG& axis = axes[i];
-		ctx.gizmoAxislAngle_Draw(axis.m_id, origin, axis.m_axis, worldRadius * 0.9f, euler[i], axis.m_color, 0.0f);
-		if (intersects && ctx.gizmoAxislAngle_Behavior(axis.m_id, origin, axis.m_axis, appData.m_snapRotation, worldRadius * 0.9f, worldSize, &euler[i]))
+		_ctx.gizmoAxislAngle_Draw(axis.m_id, origin, axis.m_axis, worldRadius * 0.9f, euler[i], axis.m_color, 0.0f);
+		if (intersects && _ctx.gizmoAxislAngle_Behavior(axis.m_id, origin, axis.m_axis, appData.m_snapRotation, worldRadius * 0.9f, worldSize, &euler[i]))
 		{
-			*outMat3 = Rotation(axis.m_axis, euler[i] - ctx.m_gizmoStateFloat) * storedRotation;
+			*outMat3 = Rotation(axis.m_axis, euler[i] - _ctx.m_gizmoStateFloat) * storedRotation;
 			ret = true;
 		}
 	}
-	if (!(ctx.m_activeId == axes[0].m_id || ctx.m_activeId == axes[1].m_id || ctx.m_activeId == axes[2].m_id))
+	if (!(_ctx.m_activeId == axes[0].m_id || _ctx.m_activeId == axes[1].m_id || _ctx.m_activeId == axes[2].m_id))
 	{
-		Vec3 viewNormal = ctx.getAppData().m_viewDirection;
+		Vec3 viewNormal = _ctx.getAppData().m_viewDirection;
 		float angle = 0.0f;
-		if (intersects && ctx.gizmoAxislAngle_Behavior(viewId, origin, viewNormal, appData.m_snapRotation, worldRadius, worldSize, &angle))
+		if (intersects && _ctx.gizmoAxislAngle_Behavior(viewId, origin, viewNormal, appData.m_snapRotation, worldRadius, worldSize, &angle))
 		{
 			*outMat3 = Rotation(viewNormal, angle) * storedRotation;
 			ret = true;
 		}
-		ctx.gizmoAxislAngle_Draw(viewId, origin, viewNormal, worldRadius, angle, viewId == ctx.m_activeId ? Color_GizmoHighlight : Color_White, 1.0f);
+		_ctx.gizmoAxislAngle_Draw(viewId, origin, viewNormal, worldRadius, angle, viewId == _ctx.m_activeId ? Color_GizmoHighlight : Color_White, 1.0f);
 	}
-	ctx.popMatrix();
+	_ctx.popMatrix();
 	#ifdef IM3D_GIZMO_LAYER_ID
-		ctx.popLayerId();
+		_ctx.popLayerId();
 	#endif
 
-	if (currentId != ctx.m_activeId)
+	if (currentId != _ctx.m_activeId)
 	{
 	 // gizmo became active, store rotation matrix
 		storedRotation = *outMat3;
 	}
-	ctx.popId();
+	_ctx.popId();
 	return ret;
 }
-bool Im3d::GizmoScale(Id _id, float _scale_[3])
+bool Im3d::GizmoScale(Context& _ctx, Id _id, float _scale_[3])
 {
-	Context& ctx = GetContext();
 
-	Vec3 origin = ctx.getMatrix().getTranslation();
-	float worldHeight = ctx.pixelsToWorldSize(origin, ctx.m_gizmoHeightPixels);
+	Vec3 origin = _ctx.getMatrix().getTranslation();
+	float worldHeight = _ctx.pixelsToWorldSize(origin, _ctx.m_gizmoHeightPixels);
 	#if IM3D_CULL_GIZMOS
-		if (!ctx.isVisible(origin, worldHeight))
+		if (!_ctx.isVisible(origin, worldHeight))
 		{
 			return false;
 		}
 	#endif
 
-	ctx.pushId(_id);
-	ctx.m_appId = _id;
+	_ctx.pushId(_id);
+	_ctx.m_appId = _id;
 
 	bool ret = false;
 	Vec3* outVec3 = (Vec3*)_scale_;
-	const AppData& appData = ctx.getAppData();
+	const AppData& appData = _ctx.getAppData();
 
 	float planeSize = worldHeight * (0.5f * 0.5f);
 	float planeOffset = worldHeight * 0.5f;
-	float worldSize = ctx.pixelsToWorldSize(origin, ctx.m_gizmoSizePixels);
+	float worldSize = _ctx.pixelsToWorldSize(origin, _ctx.m_gizmoSizePixels);
 
 	struct AxisG { Id m_id; Vec3 m_axis; Color m_color; };
 	AxisG axes[] =
 		{
-			{ MakeId("axisX"), Normalize(ctx.getMatrix().getCol(0)), Color_Red   },
-			{ MakeId("axisY"), Normalize(ctx.getMatrix().getCol(1)), Color_Green },
-			{ MakeId("axisZ"), Normalize(ctx.getMatrix().getCol(2)), Color_Blue  }
+			{ MakeId(_ctx, IM3D_STATIC_ID("axisX")), Normalize(_ctx.getMatrix().getCol(0)), Color_Red   },
+			{ MakeId(_ctx, IM3D_STATIC_ID("axisY")), Normalize(_ctx.getMatrix().getCol(1)), Color_Green },
+			{ MakeId(_ctx, IM3D_STATIC_ID("axisZ")), Normalize(_ctx.getMatrix().getCol(2)), Color_Blue  }
 		};
 
  // invert axes if viewing from behind
@@ -1228,26 +1427,26 @@ bool Im3d::GizmoScale(Id _id, float _scale_[3])
 
 	Sphere boundingSphere(origin, worldHeight);
 	Ray ray(appData.m_cursorRayOrigin, appData.m_cursorRayDirection);
-	bool intersects = ctx.m_appHotId == ctx.m_appId || Intersects(ray, boundingSphere);
+	bool intersects = _ctx.m_appHotId == _ctx.m_appId || Intersects(ray, boundingSphere);
 
 	#ifdef IM3D_GIZMO_LAYER_ID
-		ctx.pushLayerId(IM3D_GIZMO_LAYER_ID);
+		_ctx.pushLayerId(IM3D_GIZMO_LAYER_ID);
 	#endif
- 	ctx.pushEnableSorting(true);
-	ctx.pushMatrix(Mat4(1.0f));
+ 	_ctx.pushEnableSorting(true);
+	_ctx.pushMatrix(Mat4(1.0f));
 	{ // uniform scale
-		Id uniformId = MakeId("uniform");
+		Id uniformId = MakeId(_ctx, IM3D_STATIC_ID("uniform"));
 
 		if (intersects)
 		{
-			Sphere handle(origin, ctx.pixelsToWorldSize(origin, ctx.m_gizmoSizePixels * 4.0f));
+			Sphere handle(origin, _ctx.pixelsToWorldSize(origin, _ctx.m_gizmoSizePixels * 4.0f));
 			float t0, t1;
 			bool intersects = Intersect(ray, handle, t0, t1);
-			Vec3& storedScale = ctx.m_gizmoStateVec3;
-			Vec3& storedPosition = *((Vec3*)ctx.m_gizmoStateMat3.m);
-			if (uniformId == ctx.m_activeId)
+			Vec3& storedScale = _ctx.m_gizmoStateVec3;
+			Vec3& storedPosition = *((Vec3*)_ctx.m_gizmoStateMat3.m);
+			if (uniformId == _ctx.m_activeId)
 			{
-				if (ctx.isKeyDown(Action_Select))
+				if (_ctx.isKeyDown(Action_Select))
 				{
 					Plane plane(Normalize(origin - appData.m_viewOrigin), origin);
 					Intersect(ray, plane, t0);
@@ -1260,90 +1459,93 @@ bool Im3d::GizmoScale(Id _id, float _scale_[3])
 				}
 				else
 				{
-					ctx.makeActive(Id_Invalid);
+					_ctx.makeActive(Id_Invalid);
 				}
 
 			}
-			else if (uniformId == ctx.m_hotId)
+			else if (uniformId == _ctx.m_hotId)
 			{
 				if (intersects)
 				{
-					if (ctx.isKeyDown(Action_Select))
+					if (_ctx.isKeyDown(Action_Select))
 					{
-						ctx.makeActive(uniformId);
+						_ctx.makeActive(uniformId);
 						storedScale = *outVec3;
 						storedPosition = ray.m_origin + ray.m_direction * t0;
 					}
+					else
+					{
+						_ctx.makeHot(uniformId, Length2(origin - appData.m_viewOrigin), true); // remain hot in deferred mode
+					}
 				}
 				else
 				{
-					ctx.resetId();
+					_ctx.resetId();
 				}
 
 			}
 			else
 			{
 			 	float depth = Length2(origin - appData.m_viewOrigin);
-				ctx.makeHot(uniformId, depth, intersects);
+				_ctx.makeHot(uniformId, depth, intersects);
 			}
 		}
 
-		bool activeOrHot = ctx.m_activeId == uniformId || ctx.m_hotId == uniformId;
+		bool activeOrHot = _ctx.m_activeId == uniformId || _ctx.m_hotId == uniformId;
 		if (activeOrHot)
 		{
 			for (int i = 0; i < 3; ++i)
 			{
 				axes[i].m_color = Color_GizmoHighlight;
 			}
-			ctx.pushColor(Color_GizmoHighlight);
-			ctx.pushAlpha(1.0f);
-			ctx.pushSize(2.0f);
-				DrawCircle(origin, Normalize(origin - appData.m_viewOrigin), worldSize * 2.0f);
-			ctx.popSize();
-			ctx.popAlpha();
-			ctx.popColor();
+			_ctx.pushColor(Color_GizmoHighlight);
+			_ctx.pushAlpha(1.0f);
+			_ctx.pushSize(2.0f);
+				DrawCircle(_ctx, origin, Normalize(origin - appData.m_viewOrigin), worldSize * 2.0f);
+			_ctx.popSize();
+			_ctx.popAlpha();
+			_ctx.popColor();
 		}
-		ctx.pushAlpha(ctx.m_hotId == uniformId ? 1.0f : ctx.getAlpha());
-		ctx.begin(PrimitiveMode_Points);
-			ctx.vertex(origin, ctx.m_gizmoSizePixels * 2.0f, activeOrHot ? Color_GizmoHighlight : Color_White);
-		ctx.end();
-		ctx.popAlpha();
+		_ctx.pushAlpha(_ctx.m_hotId == uniformId ? 1.0f : _ctx.getAlpha());
+		_ctx.begin(PrimitiveMode_Points);
+			_ctx.vertex(origin, _ctx.m_gizmoSizePixels * 2.0f, activeOrHot ? Color_GizmoHighlight : Color_White);
+		_ctx.end();
+		_ctx.popAlpha();
 	}
 
 	for (int i = 0; i < 3; ++i)
 	{
 		AxisG& axis = axes[i];
-		ctx.gizmoAxisScale_Draw(axis.m_id, origin, axis.m_axis, worldHeight, worldSize, axis.m_color);
+		_ctx.gizmoAxisScale_Draw(axis.m_id, origin, axis.m_axis, worldHeight, worldSize, axis.m_color);
 		if (intersects)
 		{
-			ret |= ctx.gizmoAxisScale_Behavior(axis.m_id, origin, axis.m_axis, appData.m_snapScale, worldHeight, worldSize, &(*outVec3)[i]);
+			ret |= _ctx.gizmoAxisScale_Behavior(axis.m_id, origin, axis.m_axis, appData.m_snapScale, worldHeight, worldSize, &(*outVec3)[i]);
 		}
 	}
 
-	ctx.popMatrix();
-	ctx.popEnableSorting();
+	_ctx.popMatrix();
+	_ctx.popEnableSorting();
 	#ifdef IM3D_GIZMO_LAYER_ID
-		ctx.popLayerId();
+		_ctx.popLayerId();
 	#endif
 
-	ctx.popId();
+	_ctx.popId();
 	return ret;
 }
-bool Im3d::Gizmo(Id _id, float _transform_[4*4])
+bool Im3d::Gizmo(Context& _ctx, Id _id, float _transform_[4*4])
 {
 	IM3D_ASSERT(_transform_);
 
-	Context& ctx = GetContext();
  	Mat4* outMat4 = (Mat4*)_transform_;
-	ctx.pushMatrix(*outMat4);
+	_ctx.pushMatrix(*outMat4);
 
 	bool ret = false;
-	switch (ctx.m_gizmoMode)
+	switch (_ctx.m_gizmoMode)
 	{
 		case GizmoMode_Translation:
 		{
 			Vec3 translation = outMat4->getTranslation();
-			if (GizmoTranslation(_id, translation, ctx.m_gizmoLocal))
+			if (GizmoTranslation(_ctx, _id, translation, _ctx.m_gizmoLocal))
 			{
 				outMat4->setTranslation(translation);
 				ret = true;
@@ -1353,7 +1555,7 @@ bool Im3d::Gizmo(Id _id, float _transform_[4*4])
 		case GizmoMode_Rotation:
 		{
 			Mat3 rotation = outMat4->getRotation();
-			if (GizmoRotation(_id, rotation, ctx.m_gizmoLocal))
+			if (GizmoRotation(_ctx, _id, rotation, _ctx.m_gizmoLocal))
 			{
 				outMat4->setRotation(rotation);
 				ret = true;
@@ -1363,7 +1565,7 @@ bool Im3d::Gizmo(Id _id, float _transform_[4*4])
 		case GizmoMode_Scale:
 		{
 			Vec3 scale = outMat4->getScale();
-			if (GizmoScale(_id, scale))
+			if (GizmoScale(_ctx, _id, scale))
 			{
 				outMat4->setScale(scale);
 				ret = true;
@@ -1374,29 +1576,28 @@ bool Im3d::Gizmo(Id _id, float _transform_[4*4])
 			break;
 	};
 
-	ctx.popMatrix();
+	_ctx.popMatrix();
 
 	return ret;
 }
 
-bool Im3d::Gizmo(Id _id, float _translation_[3], float _rotation_[3*3], float _scale_[3])
+bool Im3d::Gizmo(Context& _ctx, Id _id, float _translation_[3], float _rotation_[3*3], float _scale_[3])
 {
-	Context& ctx = GetContext();
 
 	Mat4 transform(
 		_translation_ ? *((Vec3*)_translation_) : Vec3(0.0f),
 		_rotation_    ? *((Mat3*)_rotation_)    : Mat3(1.0f),
 		_scale_       ? *((Vec3*)_scale_)       : Vec3(1.0f)
 		);
-	ctx.pushMatrix(transform);
+	_ctx.pushMatrix(transform);
 
 	bool ret = false;
-	switch (ctx.m_gizmoMode)
+	switch (_ctx.m_gizmoMode)
 	{
 		case GizmoMode_Translation:
 			if (_translation_)
 			{
-				if (GizmoTranslation(_id, _translation_, ctx.m_gizmoLocal))
+				if (GizmoTranslation(_ctx, _id, _translation_, _ctx.m_gizmoLocal))
 				{
 					ret = true;
 				}
@@ -1405,7 +1606,7 @@ bool Im3d::Gizmo(Id _id, float _translation_[3], float _rotation_[3*3], float _s
 		case GizmoMode_Rotation:
 			if (_rotation_)
 			{
-				if (GizmoRotation(_id, _rotation_, ctx.m_gizmoLocal))
+				if (GizmoRotation(_ctx, _id, _rotation_, _ctx.m_gizmoLocal))
 				{
 					ret = true;
 				}
@@ -1414,7 +1615,7 @@ bool Im3d::Gizmo(Id _id, float _translation_[3], float _rotation_[3*3], float _s
 		case GizmoMode_Scale:
 			if (_scale_)
 			{
-				if (GizmoScale(_id, _scale_))
+				if (GizmoScale(_ctx, _id, _scale_))
 				{
 					ret = true;
 				}
@@ -1424,113 +1625,376 @@ bool Im3d::Gizmo(Id _id, float _translation_[3], float _rotation_[3*3], float _s
 			break;
 	};
 
-	ctx.popMatrix();
+	_ctx.popMatrix();
 
 	return ret;
 }
 
-void AppData::setCullFrustum(const Mat4& _viewProj, bool _ndcZNegativeOneToOne)
-{
-	m_cullFrustum[FrustumPlane_Top].x    = _viewProj(3, 0) - _viewProj(1, 0);
-	m_cullFrustum[FrustumPlane_Top].y    = _viewProj(3, 1) - _viewProj(1, 1);
-	m_cullFrustum[FrustumPlane_Top].z    = _viewProj(3, 2) - _viewProj(1, 2);
-	m_cullFrustum[FrustumPlane_Top].w    = -(_viewProj(3, 3) - _viewProj(1, 3));
+namespace {
+	struct GizmoGroupJob
+	{
+		Mat4        m_delta;            // pivotAfter * inverse(pivotBefore)
+		Mat3        m_deltaRotation;    // identity unless GizmoMode_Rotation
+		Vec3        m_deltaScale;       // (1, 1, 1) unless GizmoMode_Scale
+		float*      m_transforms;
+		U32         m_stride;
+		Vec3*       m_translations;
+		Mat3*       m_rotations;
+		Vec3*       m_scales;
+	};
+
+	void GizmoGroupApplyTransforms(void* _jobData, U32 _begin, U32 _end)
+	{
+		const GizmoGroupJob& job = *(const GizmoGroupJob*)_jobData;
+		char* transforms = (char*)job.m_transforms;
+		U32 i = _begin;
+
+		#if IM3D_SSE
+		 // operations match operator*(const Mat4&, const Mat4&) so that the results are identical
+			#ifdef IM3D_MATRIX_ROW_MAJOR
+				for (; i < _end; ++i)
+				{
+				 // ret.row(r) = sum_k delta(r, k) * t.row(k)
+					float* t = (float*)(transforms + i * job.m_stride);
+					const __m128 t0 = _mm_loadu_ps(t + 0);
+					const __m128 t1 = _mm_loadu_ps(t + 4);
+					const __m128 t2 = _mm_loadu_ps(t + 8);
+					const __m128 t3 = _mm_loadu_ps(t + 12);
+					for (int r = 0; r < 4; ++r)
+					{
+						const float* d = job.m_delta.m + r * 4;
+						__m128 ret = _mm_mul_ps(_mm_set1_ps(d[0]), t0);
+						ret = _mm_add_ps(ret, _mm_mul_ps(_mm_set1_ps(d[1]), t1));
+						ret = _mm_add_ps(ret, _mm_mul_ps(_mm_set1_ps(d[2]), t2));
+						ret = _mm_add_ps(ret, _mm_mul_ps(_mm_set1_ps(d[3]), t3));
+						_mm_storeu_ps(t + r * 4, ret);
+					}
+				}
+			#else
+				const __m128 d0 = _mm_loadu_ps(job.m_delta.m + 0);
+				const __m128 d1 = _mm_loadu_ps(job.m_delta.m + 4);
+				const __m128 d2 = _mm_loadu_ps(job.m_delta.m + 8);
+				const __m128 d3 = _mm_loadu_ps(job.m_delta.m + 12);
+				for (; i < _end; ++i)
+				{
+				 // ret.col(c) = sum_k delta.col(k) * t(k, c), each column only depends on the same column of t
+					float* t = (float*)(transforms + i * job.m_stride);
+					for (int c = 0; c < 4; ++c)
+					{
+						float* col = t + c * 4;
+						__m128 ret = _mm_mul_ps(d0, _mm_set1_ps(col[0]));
+						ret = _mm_add_ps(ret, _mm_mul_ps(d1, _mm_set1_ps(col[1])));
+						ret = _mm_add_ps(ret, _mm_mul_ps(d2, _mm_set1_ps(col[2])));
+						ret = _mm_add_ps(ret, _mm_mul_ps(d3, _mm_set1_ps(col[3])));
+						_mm_storeu_ps(col, ret);
+					}
+				}
+			#endif
+		#endif
 
-	m_cullFrustum[FrustumPlane_Bottom].x = _viewProj(3, 0) + _viewProj(1, 0);
-	m_cullFrustum[FrustumPlane_Bottom].y = _viewProj(3, 1) + _viewProj(1, 1);
-	m_cullFrustum[FrustumPlane_Bottom].z = _viewProj(3, 2) + _viewProj(1, 2);
-	m_cullFrustum[FrustumPlane_Bottom].w = -(_viewProj(3, 3) + _viewProj(1, 3));
+		for (; i < _end; ++i)
+		{
+			Mat4& t = *(Mat4*)(transforms + i * job.m_stride);
+			t = job.m_delta * t;
+		}
+	}
 
-	m_cullFrustum[FrustumPlane_Right].x  = _viewProj(3, 0) - _viewProj(0, 0);
-	m_cullFrustum[FrustumPlane_Right].y  = _viewProj(3, 1) - _viewProj(0, 1);
-	m_cullFrustum[FrustumPlane_Right].z  = _viewProj(3, 2) - _viewProj(0, 2);
-	m_cullFrustum[FrustumPlane_Right].w  = -(_viewProj(3, 3) - _viewProj(0, 3));
+	void GizmoGroupApplyTRS(void* _jobData, U32 _begin, U32 _end)
+	{
+		const GizmoGroupJob& job = *(const GizmoGroupJob*)_jobData;
+		if (job.m_translations)
+		{
+			for (U32 i = _begin; i < _end; ++i)
+			{
+				job.m_translations[i] = job.m_delta * job.m_translations[i];
+			}
+		}
+		if (job.m_rotations)
+		{
+			for (U32 i = _begin; i < _end; ++i)
+			{
+				job.m_rotations[i] = job.m_deltaRotation * job.m_rotations[i];
+			}
+		}
+		if (job.m_scales)
+		{
+			for (U32 i = _begin; i < _end; ++i)
+			{
+				job.m_scales[i] = job.m_scales[i] * job.m_deltaScale;
+			}
+		}
+	}
 
-	m_cullFrustum[FrustumPlane_Left].x   = _viewProj(3, 0) + _viewProj(0, 0);
-	m_cullFrustum[FrustumPlane_Left].y   = _viewProj(3, 1) + _viewProj(0, 1);
-	m_cullFrustum[FrustumPlane_Left].z   = _viewProj(3, 2) + _viewProj(0, 2);
-	m_cullFrustum[FrustumPlane_Left].w   = -(_viewProj(3, 3) + _viewProj(0, 3));
+	// Run the unified gizmo for _pivot_, fill the deltas in _job_ and return true if the pivot changed.
+	bool GizmoGroupBegin(Context& _ctx, Id _id, float _pivot_[4*4], GizmoGroupJob& _job_)
+	{
+		const Mat4 pivotBefore = *(const Mat4*)_pivot_;
+		if (!Gizmo(_ctx, _id, _pivot_))
+		{
+			return false;
+		}
+		const Mat4& pivotAfter = *(const Mat4*)_pivot_;
+		if (memcmp(&pivotAfter, &pivotBefore, sizeof(Mat4)) == 0)
+		{
+		 // Gizmo() returns true every frame while active, don't apply an (inexact) identity delta to all the transforms
+			return false;
+		}
 
-	m_cullFrustum[FrustumPlane_Far].x    = _viewProj(3, 0) - _viewProj(2, 0);
-	m_cullFrustum[FrustumPlane_Far].y    = _viewProj(3, 1) - _viewProj(2, 1);
-	m_cullFrustum[FrustumPlane_Far].z    = _viewProj(3, 2) - _viewProj(2, 2);
-	m_cullFrustum[FrustumPlane_Far].w    = -(_viewProj(3, 3) - _viewProj(2, 3));
+	 // a pivot axis scaled to 0 can't be divided by, leave the transforms/the corresponding scale component unchanged
+		const Vec3 scaleBefore = pivotBefore.getScale();
+		const bool invertible = scaleBefore.x != 0.0f && scaleBefore.y != 0.0f && scaleBefore.z != 0.0f;
+		_job_.m_delta = invertible ? pivotAfter * Inverse(pivotBefore) : Mat4(1.0f);
+		_job_.m_deltaRotation = Mat3(1.0f);
+		_job_.m_deltaScale = Vec3(1.0f);
+		if (_ctx.m_gizmoMode == GizmoMode_Rotation)
+		{
+			_job_.m_deltaRotation = pivotAfter.getRotation() * Transpose(pivotBefore.getRotation());
+		}
+		else if (_ctx.m_gizmoMode == GizmoMode_Scale)
+		{
+			const Vec3 scaleAfter = pivotAfter.getScale();
+			_job_.m_deltaScale.x = scaleBefore.x == 0.0f ? 1.0f : scaleAfter.x / scaleBefore.x;
+			_job_.m_deltaScale.y = scaleBefore.y == 0.0f ? 1.0f : scaleAfter.y / scaleBefore.y;
+			_job_.m_deltaScale.z = scaleBefore.z == 0.0f ? 1.0f : scaleAfter.z / scaleBefore.z;
+		}
+		return true;
+	}
 
-	if (_ndcZNegativeOneToOne)
+	void GizmoGroupApply(Context& _ctx, ParallelForJob* _apply, GizmoGroupJob& _job, U32 _count)
 	{
-		m_cullFrustum[FrustumPlane_Near].x = _viewProj(3, 0) + _viewProj(2, 0);
-		m_cullFrustum[FrustumPlane_Near].y = _viewProj(3, 1) + _viewProj(2, 1);
-		m_cullFrustum[FrustumPlane_Near].z = _viewProj(3, 2) + _viewProj(2, 2);
-		m_cullFrustum[FrustumPlane_Near].w = -(_viewProj(3, 3) + _viewProj(2, 3));
+		ParallelForCallback* parallelFor = _ctx.getAppData().parallelForCallback;
+		if (parallelFor)
+		{
+			parallelFor(_apply, &_job, _count);
+		}
+		else
+		{
+			_apply(&_job, 0, _count);
+		}
 	}
-	else
+}
+
+bool Im3d::GizmoGroup(Context& _ctx, Id _id, float _pivot_[4*4], float* _transforms_, U32 _count, U32 _stride)
+{
+	IM3D_ASSERT(_pivot_);
+	IM3D_ASSERT(_transforms_ || _count == 0);
+	IM3D_ASSERT(_stride >= sizeof(Mat4));
+
+	GizmoGroupJob job;
+	if (!GizmoGroupBegin(_ctx, _id, _pivot_, job))
 	{
-		m_cullFrustum[FrustumPlane_Near].x = _viewProj(2, 0);
-		m_cullFrustum[FrustumPlane_Near].y = _viewProj(2, 1);
-		m_cullFrustum[FrustumPlane_Near].z = _viewProj(2, 2);
-		m_cullFrustum[FrustumPlane_Near].w = -(_viewProj(2, 3));
+		return false;
 	}
+	job.m_transforms = _transforms_;
+	job.m_stride = _stride;
+	GizmoGroupApply(_ctx, &GizmoGroupApplyTransforms, job, _count);
+	return true;
+}
 
- // normalize
-	for (int i = 0; i < FrustumPlane_Count; ++i)
+bool Im3d::GizmoGroup(Context& _ctx, Id _id, float _pivot_[4*4], float* _translations_, float* _rotations_, float* _scales_, U32 _count)
+{
+	IM3D_ASSERT(_pivot_);
+
+	GizmoGroupJob job;
+	if (!GizmoGroupBegin(_ctx, _id, _pivot_, job))
 	{
-		float d = 1.0f / Length(Vec3(m_cullFrustum[i]));
-		m_cullFrustum[i] = m_cullFrustum[i] * d;
+		return false;
 	}
+	job.m_translations = (Vec3*)_translations_;
+	job.m_rotations = (Mat3*)_rotations_;
+	job.m_scales = (Vec3*)_scales_;
+	GizmoGroupApply(_ctx, &GizmoGroupApplyTRS, job, _count);
+	return true;
 }
 
-/*******************************************************************************
+// Extract normalized frustum planes from _viewProj, see AppData::setCullFrustum().
+static void ExtractFrustumPlanes(const Mat4& _viewProj, bool _ndcZNegativeOneToOne, Vec4* _planes_)
+{
+	_planes_[FrustumPlane_Top].x    = _viewProj(3, 0) - _viewProj(1, 0);
+	_planes_[FrustumPlane_Top].y    = _viewProj(3, 1) - _viewProj(1, 1);
+	_planes_[FrustumPlane_Top].z    = _viewProj(3, 2) - _viewProj(1, 2);
+	_planes_[FrustumPlane_Top].w    = -(_viewProj(3, 3) - _viewProj(1, 3));
 
-                                  Vector
+	_planes_[FrustumPlane_Bottom].x = _viewProj(3, 0) + _viewProj(1, 0);
+	_planes_[FrustumPlane_Bottom].y = _viewProj(3, 1) + _viewProj(1, 1);
+	_planes_[FrustumPlane_Bottom].z = _viewProj(3, 2) + _viewProj(1, 2);
+	_planes_[FrustumPlane_Bottom].w = -(_viewProj(3, 3) + _viewProj(1, 3));
 
-*******************************************************************************/
+	_planes_[FrustumPlane_Right].x  = _viewProj(3, 0) - _viewProj(0, 0);
+	_planes_[FrustumPlane_Right].y  = _viewProj(3, 1) - _viewProj(0, 1);
+	_planes_[FrustumPlane_Right].z  = _viewProj(3, 2) - _viewProj(0, 2);
+	_planes_[FrustumPlane_Right].w  = -(_viewProj(3, 3) - _viewProj(0, 3));
 
-static void* AlignedMalloc(size_t _size, size_t _align)
-{
-	IM3D_ASSERT(_size > 0);
-	IM3D_ASSERT(_align > 0);
-	size_t grow = (_align - 1) + sizeof(void*);
-	size_t mem = (size_t)IM3D_MALLOC(_size + grow);
-	if (mem)
+	_planes_[FrustumPlane_Left].x   = _viewProj(3, 0) + _viewProj(0, 0);
+	_planes_[FrustumPlane_Left].y   = _viewProj(3, 1) + _viewProj(0, 1);
+	_planes_[FrustumPlane_Left].z   = _viewProj(3, 2) + _viewProj(0, 2);
+	_planes_[FrustumPlane_Left].w   = -(_viewProj(3, 3) + _viewProj(0, 3));
+
+	_planes_[FrustumPlane_Far].x    = _viewProj(3, 0) - _viewProj(2, 0);
+	_planes_[FrustumPlane_Far].y    = _viewProj(3, 1) - _viewProj(2, 1);
+	_planes_[FrustumPlane_Far].z    = _viewProj(3, 2) - _viewProj(2, 2);
+	_planes_[FrustumPlane_Far].w    = -(_viewProj(3, 3) - _viewProj(2, 3));
+
+	if (_ndcZNegativeOneToOne)
 	{
-		size_t ret = (mem + grow) & (~(_align - 1));
-		IM3D_ASSERT(ret % _align == 0); // aligned correctly
-		IM3D_ASSERT(ret >= mem + sizeof(void*)); // header large enough to store a ptr
-		*((void**)(ret - sizeof(void*))) = (void*)mem;
-		return (void*)ret;
+		_planes_[FrustumPlane_Near].x = _viewProj(3, 0) + _viewProj(2, 0);
+		_planes_[FrustumPlane_Near].y = _viewProj(3, 1) + _viewProj(2, 1);
+		_planes_[FrustumPlane_Near].z = _viewProj(3, 2) + _viewProj(2, 2);
+		_planes_[FrustumPlane_Near].w = -(_viewProj(3, 3) + _viewProj(2, 3));
 	}
 	else
 	{
-		return nullptr;
+		_planes_[FrustumPlane_Near].x = _viewProj(2, 0);
+		_planes_[FrustumPlane_Near].y = _viewProj(2, 1);
+		_planes_[FrustumPlane_Near].z = _viewProj(2, 2);
+		_planes_[FrustumPlane_Near].w = -(_viewProj(2, 3));
 	}
-}
-static void AlignedFree(void* _ptr_)
-{
-	void* mem = *((void**)((size_t)_ptr_ - sizeof(void*)));
-	IM3D_FREE(mem);
-}
 
-template <typename T>
-Vector<T>::~Vector()
-{
-	if (m_data)
+ // normalize
+	for (int i = 0; i < FrustumPlane_Count; ++i)
 	{
-		AlignedFree(m_data);
-		m_data = 0;
+		float d = 1.0f / Length(Vec3(_planes_[i]));
+		_planes_[i] = _planes_[i] * d;
 	}
 }
 
-template <typename T>
-void Vector<T>::append(const T* _v, U32 _count)
+void AppData::setCullFrustum(const Mat4& _viewProj, bool _ndcZNegativeOneToOne)
 {
-	if (_count == 0)
-	{
-		return;
-	}
-	U32 sz = m_size + _count;
-	reserve(sz);
-	memcpy(end(), _v, sizeof(T) * _count);
-	m_size = sz;
+	m_viewProj = _viewProj;
+	ExtractFrustumPlanes(_viewProj, _ndcZNegativeOneToOne, m_cullFrustum);
+}
+
+void View::setCullFrustum(const Mat4& _viewProj, bool _ndcZNegativeOneToOne)
+{
+	ExtractFrustumPlanes(_viewProj, _ndcZNegativeOneToOne, m_cullFrustum);
+}
+
+void FrameConstants::update(AppData& _appData_)
+{
+	m_appData = &_appData_;
+	m_appData->m_viewDirection = Normalize(m_appData->m_viewDirection);
+
+ // copy keydown array internally so that we can make a delta to detect key presses
+	memcpy(m_keyDownPrev, m_keyDownCurr,         Key_Count); // \todo avoid this copy, use an index
+	memcpy(m_keyDownCurr, m_appData->m_keyDown, Key_Count); // must copy in case m_keyDown is updated after reset (e.g. by an app callback)
+
+ // process cull frustum
+	m_cullFrustumCount = 0;
+	for (int i = 0; i < FrustumPlane_Count; ++i)
+	{
+		const Vec4& plane = m_appData->m_cullFrustum[i];
+		if (m_appData->m_projOrtho && i == FrustumPlane_Near) // skip near plane if perspective
+		{
+			continue;
+		}
+		if (std::isinf(plane.w)) // may be the case e.g. for the far plane if projection is infinite
+		{
+			continue;
+		}
+		m_cullFrustum[m_cullFrustumCount++] = plane;
+	}
+}
+
+void InteractionState::resolve()
+{
+	const U32 hotSerial = (U32)(m_hotCandidate & 0xffffffffu);
+	const Context* hot = nullptr;
+	const Context* activated = nullptr;
+	for (const Context* ctx = m_submitted; ctx; ctx = ctx->m_interactionNext)
+	{
+		if (m_hotCandidate != ~0ull && ctx->m_serial == hotSerial)
+		{
+			hot = ctx;
+		}
+	 // normally only the context which evaluated the hot/active gizmo changes activation, the lowest serial wins otherwise
+		if (ctx->m_activeId != ctx->m_activeIdAtReset && (!activated || ctx->m_serial < activated->m_serial))
+		{
+			activated = ctx;
+		}
+	}
+
+	if (activated)
+	{
+		m_activeId        = activated->m_activeId;
+		m_appActiveId     = activated->m_appActiveId;
+		m_gizmoStateVec3  = activated->m_gizmoStateVec3;
+		m_gizmoStateMat3  = activated->m_gizmoStateMat3;
+		m_gizmoStateFloat = activated->m_gizmoStateFloat;
+	}
+	if (m_activeId != Id_Invalid)
+	{
+		m_hotId    = m_activeId;
+		m_appHotId = m_appActiveId;
+	}
+	else if (hot)
+	{
+		m_hotId    = hot->m_hotCandidateId;
+		m_appHotId = hot->m_appHotCandidateId;
+		m_hotDepth = hot->m_hotCandidateDepth;
+	}
+	else
+	{
+		m_hotId    = Id_Invalid;
+		m_appHotId = Id_Invalid;
+		m_hotDepth = FLT_MAX;
+	}
+
+	m_hotCandidate = ~0ull;
+	m_submitted = nullptr;
+}
+
+/*******************************************************************************
+
+                                  Vector
+
+*******************************************************************************/
+
+static void* AlignedMalloc(size_t _size, size_t _align)
+{
+	IM3D_ASSERT(_size > 0);
+	IM3D_ASSERT(_align > 0);
+	size_t grow = (_align - 1) + sizeof(void*);
+	size_t mem = (size_t)IM3D_MALLOC(_size + grow);
+	if (mem)
+	{
+		size_t ret = (mem + grow) & (~(_align - 1));
+		IM3D_ASSERT(ret % _align == 0); // aligned correctly
+		IM3D_ASSERT(ret >= mem + sizeof(void*)); // header large enough to store a ptr
+		*((void**)(ret - sizeof(void*))) = (void*)mem;
+		return (void*)ret;
+	}
+	else
+	{
+		return nullptr;
+	}
+}
+static void AlignedFree(void* _ptr_)
+{
+	void* mem = *((void**)((size_t)_ptr_ - sizeof(void*)));
+	IM3D_FREE(mem);
+}
+
+template <typename T>
+Vector<T>::~Vector()
+{
+	if (m_data)
+	{
+		AlignedFree(m_data);
+		m_data = 0;
+	}
+}
+
+template <typename T>
+void Vector<T>::append(const T* _v, U32 _count)
+{
+	if (_count == 0)
+	{
+		return;
+	}
+	U32 sz = m_size + _count;
+	reserve(sz);
+	memcpy(end(), _v, sizeof(T) * _count);
+	m_size = sz;
 }
 
 template <typename T>
@@ -1554,8 +2018,7 @@ void Vector<T>::reserve(U32 _capacity)
 template <typename T>
 void Vector<T>::resize(U32 _size, const T& _val)
 {
-	IM3D_ASSERT(_size >= m_size); // only support growing the vector
-	reserve(_size);
+	reserve(_size); // shrinking just truncates
 	while (m_size < _size)
 	{
 		push_back(_val);
@@ -1566,8 +2029,7 @@ void Vector<T>::resize(U32 _size, const T& _val)
 template <typename T>
 void Vector<T>::resize(U32 _size)
 {
-	IM3D_ASSERT(_size >= m_size); // only support growing the vector
-	reserve(_size);
+	reserve(_size); // shrinking just truncates
 	m_size = _size;
 }
 
@@ -1592,6 +2054,270 @@ template struct Im3d::Vector<Id>;
 template struct Im3d::Vector<Mat4>;
 template struct Im3d::Vector<Color>;
 template struct Im3d::Vector<DrawList>;
+template struct Im3d::Vector<LayerPolicy>;
+template struct Im3d::Vector<View>;
+template struct Im3d::Vector<TextVertex>;
+template struct Im3d::Vector<TextQuadList>;
+
+/*******************************************************************************
+
+                                 OcclusionBuffer
+
+*******************************************************************************/
+
+static const float kOcclusionMinW = 1e-5f; // occluders are clipped against w = kOcclusionMinW, bounds crossing it are never occluded
+
+OcclusionBuffer::OcclusionBuffer(U32 _width, U32 _height)
+	: m_viewProj(1.0f)
+	, m_width(_width)
+	, m_height(_height)
+{
+	IM3D_ASSERT(_width > 0 && _height > 0);
+	U32 size = 0;
+	m_levelCount = 0;
+	for (;;)
+	{
+		m_levelWidth[m_levelCount]  = _width;
+		m_levelHeight[m_levelCount] = _height;
+		m_levelOffset[m_levelCount] = size;
+		size += _width * _height;
+		++m_levelCount;
+		if ((_width == 1 && _height == 1) || m_levelCount == kMaxLevels)
+		{
+			break;
+		}
+		_width  = (_width  + 1) / 2;
+		_height = (_height + 1) / 2;
+	}
+	m_depth.resize(size, FLT_MAX);
+}
+
+void OcclusionBuffer::begin(const Mat4& _viewProj)
+{
+	m_viewProj = _viewProj;
+	for (float& depth : m_depth)
+	{
+		depth = FLT_MAX;
+	}
+}
+
+void OcclusionBuffer::rasterize(const Vec3* _vertices, U32 _vertexCount, const Mat4& _world, U32 _rowBegin, U32 _rowEnd)
+{
+	IM3D_ASSERT(_vertexCount % 3 == 0);
+	_rowEnd = _rowEnd < m_height ? _rowEnd : m_height;
+	if (_rowBegin >= _rowEnd)
+	{
+		return;
+	}
+
+	const Mat4 worldViewProj = m_viewProj * _world;
+	for (U32 i = 0; i + 3 <= _vertexCount; i += 3)
+	{
+		const Vec4 clip[3] =
+		{
+			worldViewProj * Vec4(_vertices[i + 0], 1.0f),
+			worldViewProj * Vec4(_vertices[i + 1], 1.0f),
+			worldViewProj * Vec4(_vertices[i + 2], 1.0f)
+		};
+
+	 // clip against w = kOcclusionMinW, the result is a triangle or a quad
+		Vec3 screen[4];
+		int n = 0;
+		for (int j = 0; j < 3; ++j)
+		{
+			const Vec4& a = clip[j];
+			const Vec4& b = clip[(j + 1) % 3];
+			const bool aIn = a.w >= kOcclusionMinW;
+			const bool bIn = b.w >= kOcclusionMinW;
+			Vec4 v[2];
+			int vn = 0;
+			if (aIn)
+			{
+				v[vn++] = a;
+			}
+			if (aIn != bIn)
+			{
+				v[vn++] = a + (b - a) * ((kOcclusionMinW - a.w) / (b.w - a.w));
+			}
+			for (int k = 0; k < vn; ++k)
+			{
+				screen[n++] = Vec3(
+					(v[k].x / v[k].w * 0.5f + 0.5f) * (float)m_width,
+					(v[k].y / v[k].w * 0.5f + 0.5f) * (float)m_height,
+					v[k].z / v[k].w
+					);
+			}
+		}
+		if (n >= 3)
+		{
+			rasterizeTriangle(screen[0], screen[1], screen[2], _rowBegin, _rowEnd);
+		}
+		if (n == 4)
+		{
+			rasterizeTriangle(screen[0], screen[2], screen[3], _rowBegin, _rowEnd);
+		}
+	}
+}
+
+void OcclusionBuffer::end()
+{
+ // each texel in level i is the farthest of the (up to) 2x2 texels in level i - 1
+	for (U32 level = 1; level < m_levelCount; ++level)
+	{
+		const float* src = m_depth.data() + m_levelOffset[level - 1];
+		float* dst = m_depth.data() + m_levelOffset[level];
+		const U32 srcWidth  = m_levelWidth[level - 1];
+		const U32 srcHeight = m_levelHeight[level - 1];
+		for (U32 y = 0; y < m_levelHeight[level]; ++y)
+		{
+			const U32 y0 = y * 2;
+			const U32 y1 = y0 + 1 < srcHeight ? y0 + 1 : y0;
+			for (U32 x = 0; x < m_levelWidth[level]; ++x)
+			{
+				const U32 x0 = x * 2;
+				const U32 x1 = x0 + 1 < srcWidth ? x0 + 1 : x0;
+				dst[y * m_levelWidth[level] + x] = Max(
+					Max(src[y0 * srcWidth + x0], src[y0 * srcWidth + x1]),
+					Max(src[y1 * srcWidth + x0], src[y1 * srcWidth + x1])
+					);
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::isOccluded(const Vec3& _min, const Vec3& _max) const
+{
+	Vec2 ndcMin = Vec2(FLT_MAX);
+	Vec2 ndcMax = Vec2(-FLT_MAX);
+	float depth = FLT_MAX;
+	for (int i = 0; i < 8; ++i)
+	{
+		const Vec4 clip = m_viewProj * Vec4(
+			(i & 1) ? _max.x : _min.x,
+			(i & 2) ? _max.y : _min.y,
+			(i & 4) ? _max.z : _min.z,
+			1.0f
+			);
+		if (clip.w < kOcclusionMinW)
+		{
+			return false;
+		}
+		const Vec2 ndc = Vec2(clip.x / clip.w, clip.y / clip.w);
+		ndcMin = Min(ndcMin, ndc);
+		ndcMax = Max(ndcMax, ndc);
+		depth = Min(depth, clip.z / clip.w);
+	}
+	return isOccluded(ndcMin, ndcMax, depth);
+}
+
+bool OcclusionBuffer::isOccluded(const Vec3& _origin, float _radius) const
+{
+	return isOccluded(_origin - Vec3(_radius), _origin + Vec3(_radius));
+}
+
+bool OcclusionBuffer::isOccluded(const Vec2& _min, const Vec2& _max, float _depth) const
+{
+	float x0 = (_min.x * 0.5f + 0.5f) * (float)m_width;
+	float y0 = (_min.y * 0.5f + 0.5f) * (float)m_height;
+	float x1 = (_max.x * 0.5f + 0.5f) * (float)m_width;
+	float y1 = (_max.y * 0.5f + 0.5f) * (float)m_height;
+	if (x1 < 0.0f || y1 < 0.0f || x0 >= (float)m_width || y0 >= (float)m_height)
+	{
+		return false; // offscreen, leave to frustum culling
+	}
+
+ // select the level at which the rectangle covers at most 2x2 texels
+	int tx0 = (int)Max(x0, 0.0f);
+	int ty0 = (int)Max(y0, 0.0f);
+	int tx1 = (int)Min(x1, (float)m_width  - 1.0f);
+	int ty1 = (int)Min(y1, (float)m_height - 1.0f);
+	U32 level = 0;
+	while (level + 1 < m_levelCount && (tx1 - tx0 > 1 || ty1 - ty0 > 1))
+	{
+		tx0 >>= 1;
+		ty0 >>= 1;
+		tx1 >>= 1;
+		ty1 >>= 1;
+		++level;
+	}
+
+	const float* depth = getDepth(level);
+	const U32 width = m_levelWidth[level];
+	for (int y = ty0; y <= ty1; ++y)
+	{
+		for (int x = tx0; x <= tx1; ++x)
+		{
+			if (depth[y * width + x] >= _depth) // standard Z, greater depth is farther (see OcclusionBuffer)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void OcclusionBuffer::rasterizeTriangle(Vec3 _a, Vec3 _b, Vec3 _c, U32 _rowBegin, U32 _rowEnd)
+{
+	float area = (_b.x - _a.x) * (_c.y - _a.y) - (_b.y - _a.y) * (_c.x - _a.x);
+	if (area < 0.0f)
+	{
+	 // occluders are double sided, flip to CCW
+		Vec3 tmp = _b;
+		_b = _c;
+		_c = tmp;
+		area = -area;
+	}
+	if (area < FLT_EPSILON)
+	{
+		return;
+	}
+
+ // depth plane z = _a.z + dzdx * (x - _a.x) + dzdy * (y - _a.y)
+	const float dzdx = ((_b.z - _a.z) * (_c.y - _a.y) - (_c.z - _a.z) * (_b.y - _a.y)) / area;
+	const float dzdy = ((_c.z - _a.z) * (_b.x - _a.x) - (_b.z - _a.z) * (_c.x - _a.x)) / area;
+	const float dzTexel = 0.5f * (fabs(dzdx) + fabs(dzdy)); // center -> farthest texel corner, stored depth is conservative
+
+ // edge functions E(x, y) = A * x + B * y + C, positive inside; only texels entirely inside the triangle store depth, hence each edge is
+ // moved inward by half a texel (the maximum of |E(center) - E(corner)|). Partially covered texels would store the occluder depth for
+ // texels which are partly unoccluded; the gaps this leaves along edges shared between triangles only make culling less aggressive
+	const Vec3 v[3] = { _a, _b, _c };
+	float A[3], B[3], C[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		const Vec3& p = v[i];
+		const Vec3& q = v[(i + 1) % 3];
+		A[i] = p.y - q.y;
+		B[i] = q.x - p.x;
+		C[i] = -(A[i] * p.x + B[i] * p.y) - 0.5f * (fabs(A[i]) + fabs(B[i]));
+	}
+
+ // bounding box, clamp before converting to int (clipped vertices may project far outside the buffer)
+	const float fw = (float)m_width;
+	const float fh = (float)m_height;
+	const int x0 = (int)Clamp(floorf(Min(Min(_a.x, _b.x), _c.x)), 0.0f, fw);
+	const int x1 = (int)Clamp(ceilf (Max(Max(_a.x, _b.x), _c.x)), 0.0f, fw);
+	const int y0 = (int)Max(Clamp(floorf(Min(Min(_a.y, _b.y), _c.y)), 0.0f, fh), (float)_rowBegin);
+	const int y1 = (int)Min(Clamp(ceilf (Max(Max(_a.y, _b.y), _c.y)), 0.0f, fh), (float)_rowEnd);
+
+	float* depth = m_depth.data();
+	for (int y = y0; y < y1; ++y)
+	{
+		const float py = (float)y + 0.5f;
+		for (int x = x0; x < x1; ++x)
+		{
+			const float px = (float)x + 0.5f;
+			if (A[0] * px + B[0] * py + C[0] < 0.0f
+			 || A[1] * px + B[1] * py + C[1] < 0.0f
+			 || A[2] * px + B[2] * py + C[2] < 0.0f)
+			{
+				continue;
+			}
+			const float z = _a.z + dzdx * (px - _a.x) + dzdy * (py - _a.y) + dzTexel;
+			float& dst = depth[y * m_width + x];
+			dst = Min(dst, z);
+		}
+	}
+}
 
 /*******************************************************************************
 
@@ -1599,9 +2325,26 @@ template struct Im3d::Vector<DrawList>;
 
 *******************************************************************************/
 
+static U32 g_ContextSerial = 0;
 static Context g_DefaultContext;
 IM3D_THREAD_LOCAL Context* Im3d::internal::g_CurrentContext = &g_DefaultContext;
 
+#if IM3D_THREAD_SAFE_SUBMISSION
+namespace {
+	struct ThreadContextCache
+	{
+		U32         m_serial     = 0;       // Context::m_serial of the last context resolved on this thread.
+		const void* m_owner      = nullptr; // Context::m_ownerThread when m_context was resolved, reset() may move ownership to another thread.
+		U32         m_generation = 0;       // Context::m_producerGeneration when m_context was resolved, reset() may destroy idle producers.
+		Context*    m_context    = nullptr; // Context to submit to.
+	};
+	thread_local ThreadContextCache g_ThreadContextCache;
+
+	// The address of a thread_local is unique per live thread.
+	inline const void* GetThreadTag() { return &g_ThreadContextCache; }
+}
+#endif
+
 void Context::begin(PrimitiveMode _mode)
 {
 	IM3D_ASSERT(!m_endFrameCalled); // Begin*() called after EndFrame() but before NewFrame(), or forgot to call NewFrame()
@@ -1626,6 +2369,10 @@ void Context::begin(PrimitiveMode _mode)
 			break;
 	};
 	m_firstVertThisPrim = getCurrentVertexList()->size();
+	m_discardThisPrim = m_cullScopeCulled || m_alphaStack.back() == 0.0f; // all vertices would be culled or fully transparent
+	m_layerPolicyThisPrim = getLayerPolicy();
+	m_viewOriginThisPrim = getAppData().m_viewOrigin;
+	m_fadeThisPrim = m_layerPolicyThisPrim.m_fadeDistance > 0.0f && m_layerPolicyThisPrim.m_maxDistance > 0.0f;
 }
 
 void Context::end()
@@ -1659,14 +2406,36 @@ void Context::end()
 				break;
 		};
 		#if IM3D_CULL_PRIMITIVES
-		 // \hack force the bounds to be slightly conservative to account for point/line size
-			m_minVertThisPrim = m_minVertThisPrim - Vec3(1.0f);
-			m_maxVertThisPrim = m_maxVertThisPrim + Vec3(1.0f);
 			if (!isVisible(m_minVertThisPrim, m_maxVertThisPrim))
 			{
-				vertexList->resize(m_firstVertThisPrim, VertexData());
+				m_culledPrimitiveCount[m_primType] += (vertexList->size() - m_firstVertThisPrim) / VertsPerDrawPrimitive[m_primType];
+				vertexList->resize(m_firstVertThisPrim);
 			}
 		#endif
+
+	 // points have an explicit pixel size so are never culled by size
+		const U32 vertexCount = vertexList->size() - m_firstVertThisPrim;
+		if (getAppData().m_minPixelSize > 0.0f && m_primMode != PrimitiveMode_Points && vertexCount > 0)
+		{
+			if (BelowMinPixelSize(*this, vertexList->data() + m_firstVertThisPrim, vertexCount))
+			{
+				m_culledPrimitiveCount[m_primType] += vertexCount / VertsPerDrawPrimitive[m_primType];
+				vertexList->resize(m_firstVertThisPrim);
+			}
+		}
+
+		if (m_layerPolicyThisPrim.m_maxDistance > 0.0f && vertexList->size() > m_firstVertThisPrim)
+		{
+			if (BeyondMaxDistance(m_layerPolicyThisPrim, m_viewOriginThisPrim, vertexList->data() + m_firstVertThisPrim, vertexCount))
+			{
+				m_culledPrimitiveCount[m_primType] += vertexCount / VertsPerDrawPrimitive[m_primType];
+				vertexList->resize(m_firstVertThisPrim);
+			}
+		}
+	}
+	if (m_vertexDataIndex == 0)
+	{
+		flushVertexList(m_layerIndex, m_primType);
 	}
 	m_primMode = PrimitiveMode_None;
 	m_primType = DrawPrimitive_Count;
@@ -1690,6 +2459,10 @@ void Context::end()
 void Context::vertex(const Vec3& _position, float _size, Color _color)
 {
 	IM3D_ASSERT(m_primMode != PrimitiveMode_None); // Vertex() called without Begin*()
+	if_unlikely (m_discardThisPrim)
+	{
+		return;
+	}
 
 	VertexData vd(_position, _size, _color);
 	if (m_matrixStack.size() > 1) // optim, skip the matrix multiplication when the stack size is 1
@@ -1697,17 +2470,24 @@ void Context::vertex(const Vec3& _position, float _size, Color _color)
 		vd.m_positionSize = Vec4(m_matrixStack.back() * _position, _size);
 	}
 	vd.m_color.setA(vd.m_color.getA() * m_alphaStack.back());
+	if_unlikely (m_fadeThisPrim)
+	{
+		vd.m_color.setA(vd.m_color.getA() * DistanceFade(m_layerPolicyThisPrim, m_viewOriginThisPrim, Vec3(vd.m_positionSize)));
+	}
 
 	#if IM3D_CULL_PRIMITIVES
-		Vec3 p = Vec3(vd.m_positionSize);
+	 // inflate the bounds by the vertex size (as per isVisible(const VertexData*, DrawPrimitiveType))
+		const Vec3 p = Vec3(vd.m_positionSize);
+		const Vec3 r = Vec3(m_primType == DrawPrimitive_Triangles ? 0.0f : pixelsToWorldSize(p, _size));
 		if (m_vertCountThisPrim == 0) // p is the first vertex
 		{
-			m_minVertThisPrim = m_maxVertThisPrim = p;
+			m_minVertThisPrim = p - r;
+			m_maxVertThisPrim = p + r;
 		}
 		else
 		{
-			m_minVertThisPrim = Min(m_minVertThisPrim, p);
-			m_maxVertThisPrim = Max(m_maxVertThisPrim, p);
+			m_minVertThisPrim = Min(m_minVertThisPrim, p - r);
+			m_maxVertThisPrim = Max(m_maxVertThisPrim, p + r);
 		}
 	#endif
 
@@ -1791,8 +2571,52 @@ void Context::vertex(const Vec3& _position, float _size, Color _color)
 	#endif
 }
 
+void Context::vertices(const VertexData* _vertices, U32 _count)
+{
+	IM3D_ASSERT(m_primMode == PrimitiveMode_Points || m_primMode == PrimitiveMode_Lines || m_primMode == PrimitiveMode_Triangles);
+	if_unlikely (m_discardThisPrim || _count == 0)
+	{
+		return;
+	}
+
+	VertexList* vertexList = getCurrentVertexList();
+	const U32 first = vertexList->size();
+	vertexList->append(_vertices, _count);
+
+	const float alpha = m_alphaStack.back();
+	for (U32 i = first, n = first + _count; i < n; ++i)
+	{
+		VertexData& vd = (*vertexList)[i];
+		vd.m_color.setA(vd.m_color.getA() * alpha);
+		if_unlikely (m_fadeThisPrim)
+		{
+			vd.m_color.setA(vd.m_color.getA() * DistanceFade(m_layerPolicyThisPrim, m_viewOriginThisPrim, Vec3(vd.m_positionSize)));
+		}
+
+		#if IM3D_CULL_PRIMITIVES
+			const Vec3 p = Vec3(vd.m_positionSize);
+			const Vec3 r = Vec3(m_primType == DrawPrimitive_Triangles ? 0.0f : pixelsToWorldSize(p, vd.m_positionSize.w));
+			if (m_vertCountThisPrim == 0 && i == first)
+			{
+				m_minVertThisPrim = p - r;
+				m_maxVertThisPrim = p + r;
+			}
+			else
+			{
+				m_minVertThisPrim = Min(m_minVertThisPrim, p - r);
+				m_maxVertThisPrim = Max(m_maxVertThisPrim, p + r);
+			}
+		#endif
+	}
+	m_vertCountThisPrim += _count;
+}
+
 void Context::text(const Vec3& _position, float _size, Color _color, TextFlags _flags, const char* _textStart, const char* _textEnd)
 {
+	if_unlikely (m_cullScopeCulled)
+	{
+		return;
+	}
 	TextData& td = getCurrentTextList()->push_back();
 	td.m_positionSize = Vec4(_position, _size);
 	if (m_matrixStack.size() > 1) // optim, skip the matrix multiplication when the stack size is 1
@@ -1812,26 +2636,171 @@ void Context::text(const Vec3& _position, float _size, Color _color, TextFlags _
 }
 
 
-void Context::text(const Vec3& _position, float _size, Color _color, TextFlags _flags, const char* _text, va_list _args)
+Id Context::internText(const char* _textStart, const char* _textEnd)
 {
-	TextData& td = getCurrentTextList()->push_back();
-	td.m_positionSize = Vec4(_position, _size);
-	if (m_matrixStack.size() > 1) // optim, skip the matrix multiplication when the stack size is 1
+	if (!_textEnd)
 	{
-		td.m_positionSize = Vec4(m_matrixStack.back() * _position, _size);
+		_textEnd = _textStart + strlen(_textStart);
 	}
-	td.m_color = _color;
-	td.m_color.setA(td.m_color.getA() * m_alphaStack.back());
-	td.m_flags = _flags;
-	td.m_textBufferOffset = m_textBuffer.size();
+	const U32 length = (U32)(_textEnd - _textStart);
+	Id id = Hash(_textStart, (int)length, internal::kFnv1aBase32);
 
-	va_list argsCopy;
-	va_copy(argsCopy, _args);
-	td.m_textLength = (U32)vsnprintf(nullptr, 0, _text, argsCopy);
+ // on a hash collision with a different string probe to the next ID, the string interned first keeps the hash as its ID
+	for (;;)
+	{
+		if (id != Id_Invalid)
+		{
+			const int existing = findInternedText(id);
+			if (existing == -1)
+			{
+				break;
+			}
+			if (m_textIntern[existing * 3 + 2] == length && memcmp(m_textBuffer.data() + m_textIntern[existing * 3 + 1], _textStart, length) == 0)
+			{
+				return id;
+			}
+		}
+		++id;
+	}
+
+ // append to the text buffer, reset() moves the string into the persistent region at the start of the buffer
+	const U32 offset = m_textBuffer.size();
+	m_textBuffer.resize(offset + length + 1);
+	memcpy(m_textBuffer.data() + offset, _textStart, (size_t)length);
+	m_textBuffer.back() = '\0';
+	m_textIntern.push_back(id);
+	m_textIntern.push_back(offset);
+	m_textIntern.push_back(length);
+	m_textInternDirty = true;
+	++m_textInternVersion;
+
+ // grow the hash table to keep the load factor <= 0.5
+	const U32 count = m_textIntern.size() / 3;
+	if (count * 2 > m_textInternSlots.size())
+	{
+		const U32 slotCount = m_textInternSlots.empty() ? 64 : m_textInternSlots.size() * 2;
+		m_textInternSlots.resize(slotCount);
+		memset(m_textInternSlots.data(), 0, slotCount * sizeof(U32));
+		for (U32 i = 0; i < count; ++i)
+		{
+			U32 slot = m_textIntern[i * 3] & (slotCount - 1);
+			while (m_textInternSlots[slot] != 0)
+			{
+				slot = (slot + 1) & (slotCount - 1);
+			}
+			m_textInternSlots[slot] = i + 1;
+		}
+	}
+	else
+	{
+		const U32 slotMask = m_textInternSlots.size() - 1;
+		U32 slot = id & slotMask;
+		while (m_textInternSlots[slot] != 0)
+		{
+			slot = (slot + 1) & slotMask;
+		}
+		m_textInternSlots[slot] = count;
+	}
+	return id;
+}
+
+void Context::text(const Vec3& _position, float _size, Color _color, TextFlags _flags, Id _textId)
+{
+	if_unlikely (m_cullScopeCulled)
+	{
+		return;
+	}
+	const int index = findInternedText(_textId);
+	if_unlikely (index == -1)
+	{
+		IM3D_ASSERT(false); // _textId wasn't returned by internText(), or was interned on the parent after its last reset()
+		return;
+	}
+	TextData& td = getCurrentTextList()->push_back();
+	td.m_positionSize = Vec4(_position, _size);
+	if (m_matrixStack.size() > 1) // optim, skip the matrix multiplication when the stack size is 1
+	{
+		td.m_positionSize = Vec4(m_matrixStack.back() * _position, _size);
+	}
+	td.m_color = _color;
+	td.m_color.setA(td.m_color.getA() * m_alphaStack.back());
+	td.m_flags = _flags;
+	td.m_textBufferOffset = m_textIntern[index * 3 + 1];
+	td.m_textLength = m_textIntern[index * 3 + 2];
+}
+
+void Context::clearInternedText()
+{
+	m_textIntern.clear();
+	m_textInternSlots.clear();
+	m_textInternDirty = true;
+	++m_textInternVersion;
+}
+
+int Context::findInternedText(Id _textId) const
+{
+	if (m_textInternSlots.empty())
+	{
+		return -1;
+	}
+	const U32 slotMask = m_textInternSlots.size() - 1;
+	for (U32 slot = _textId & slotMask; m_textInternSlots[slot] != 0; slot = (slot + 1) & slotMask)
+	{
+		const U32 index = m_textInternSlots[slot] - 1;
+		if (m_textIntern[index * 3] == _textId)
+		{
+			return (int)index;
+		}
+	}
+	return -1;
+}
+
+static const U32 kTextFormatReserve = 256; // minimum spare capacity in m_textBuffer for single pass formatting
 
+void Context::text(const Vec3& _position, float _size, Color _color, TextFlags _flags, const char* _text, va_list _args)
+{
+	if_unlikely (m_cullScopeCulled)
+	{
+		return;
+	}
+	TextData& td = getCurrentTextList()->push_back();
+	td.m_positionSize = Vec4(_position, _size);
+	if (m_matrixStack.size() > 1) // optim, skip the matrix multiplication when the stack size is 1
+	{
+		td.m_positionSize = Vec4(m_matrixStack.back() * _position, _size);
+	}
+	td.m_color = _color;
+	td.m_color.setA(td.m_color.getA() * m_alphaStack.back());
+	td.m_flags = _flags;
+	td.m_textBufferOffset = m_textBuffer.size();
+
+ // format directly into the spare capacity of m_textBuffer, only format a second time if the result didn't fit
 	const U32 copyOffset = m_textBuffer.size();
+	if (m_textBuffer.capacity() - copyOffset < kTextFormatReserve)
+	{
+		const U32 capacity = m_textBuffer.capacity() + m_textBuffer.capacity() / 2;
+		m_textBuffer.reserve(capacity > copyOffset + kTextFormatReserve ? capacity : copyOffset + kTextFormatReserve);
+	}
+	U32 available = m_textBuffer.capacity() - copyOffset;
+	m_textBuffer.resize(copyOffset + available);
+
+	va_list argsCopy;
+	va_copy(argsCopy, _args);
+	int len = vsnprintf(m_textBuffer.data() + copyOffset, available, _text, argsCopy);
+	va_end(argsCopy);
+	if_unlikely (len < 0) // encoding error
+	{
+		len = 0;
+	}
+	else if_unlikely ((U32)len >= available)
+	{
+		m_textBuffer.resize(copyOffset + (U32)len + 1);
+		va_copy(argsCopy, _args);
+		vsnprintf(m_textBuffer.data() + copyOffset, (U32)len + 1, _text, argsCopy);
+		va_end(argsCopy);
+	}
+	td.m_textLength = (U32)len;
 	m_textBuffer.resize(copyOffset + td.m_textLength + 1);
-	vsnprintf(m_textBuffer.data() + copyOffset, td.m_textLength + 1, _text, argsCopy);
 	m_textBuffer.back() = '\0';
 }
 
@@ -1843,6 +2812,7 @@ void Context::reset()
 	IM3D_ASSERT(m_sizeStack.size() == 1);
 	IM3D_ASSERT(m_enableSortingStack.size() == 1);
 	IM3D_ASSERT(m_layerIdStack.size() == 1);
+	IM3D_ASSERT(m_cullScopeStack.size() == 1);
 	IM3D_ASSERT(m_matrixStack.size() == 1);
 	IM3D_ASSERT(m_idStack.size() == 1);
 
@@ -1857,67 +2827,298 @@ void Context::reset()
 		m_vertexData[1][i]->clear();
 	}
 	m_drawLists.clear();
+	m_viewDrawLists.clear();
+	m_viewDrawListStart.clear();
 	for (U32 i = 0; i < m_textData.size(); ++i)
 	{
 		m_textData[i]->clear();
 	}
 	m_textDrawLists.clear();
-	m_textBuffer.clear();
+	if (m_textInternDirty)
+	{
+	 // move interned strings to the start of the buffer, offsets are in ascending order hence dst never overtakes src
+		U32 size = 0;
+		for (U32 i = 0; i < m_textIntern.size(); i += 3)
+		{
+			const U32 offset = m_textIntern[i + 1];
+			const U32 length = m_textIntern[i + 2] + 1;
+			memmove(m_textBuffer.data() + size, m_textBuffer.data() + offset, (size_t)length);
+			m_textIntern[i + 1] = size;
+			size += length;
+		}
+		m_textInternSize = size;
+		m_textInternDirty = false;
+	}
+	m_textBuffer.resize(m_textInternSize);
+	m_textVertexData.clear();
+	m_textQuadLists.clear();
 
 	m_sortCalled = false;
 	m_endFrameCalled = false;
+	memset(m_culledPrimitiveCount, 0, sizeof(m_culledPrimitiveCount));
+	m_culledTextCount = 0;
+	m_pickId = Id_Invalid;
+	m_pickDepth = FLT_MAX;
 
-	m_appData.m_viewDirection = Normalize(m_appData.m_viewDirection);
+	if (m_frameConstants == &m_localFrameConstants) // else shared constants were already updated by the app
+	{
+		m_localFrameConstants.update(m_appData);
+	}
 
- // copy keydown array internally so that we can make a delta to detect key presses
-	memcpy(m_keyDownPrev, m_keyDownCurr,       Key_Count); // \todo avoid this copy, use an index
-	memcpy(m_keyDownCurr, m_appData.m_keyDown, Key_Count); // must copy in case m_keyDown is updated after reset (e.g. by an app callback)
+ // shared interaction state was resolved since the previous frame (see InteractionState::resolve())
+	if (m_interactionState)
+	{
+		m_hotId           = m_interactionState->m_hotId;
+		m_appHotId        = m_interactionState->m_appHotId;
+		m_hotDepth        = m_interactionState->m_hotDepth;
+		m_activeId        = m_interactionState->m_activeId;
+		m_appActiveId     = m_interactionState->m_appActiveId;
+		m_gizmoStateVec3  = m_interactionState->m_gizmoStateVec3;
+		m_gizmoStateMat3  = m_interactionState->m_gizmoStateMat3;
+		m_gizmoStateFloat = m_interactionState->m_gizmoStateFloat;
+	}
+	m_deferHot = m_interactionState || getAppData().m_deferHotResolution;
+	m_hotCandidateId = m_appHotCandidateId = Id_Invalid;
+	m_hotCandidateDepth = FLT_MAX;
+	m_activeIdAtReset = m_activeId; // before the mode changes below, releasing the active gizmo is an activation change
 
- // process cull frustum
-	m_cullFrustumCount = 0;
-	for (int i = 0; i < FrustumPlane_Count; ++i)
+ // update gizmo modes (producers copy them from the parent, see syncProducer())
+	if (!m_producerParent)
 	{
-		const Vec4& plane = m_appData.m_cullFrustum[i];
-		if (m_appData.m_projOrtho && i == FrustumPlane_Near) // skip near plane if perspective
+		if (wasKeyPressed(Action_GizmoTranslation))
 		{
-			continue;
+			m_gizmoMode = GizmoMode_Translation;
+			resetId();
 		}
-		if (std::isinf(plane.w)) // may be the case e.g. for the far plane if projection is infinite
+		else if (wasKeyPressed(Action_GizmoRotation))
 		{
-			continue;
+			m_gizmoMode = GizmoMode_Rotation;
+			resetId();
+		}
+		else if (wasKeyPressed(Action_GizmoScale))
+		{
+			m_gizmoMode = GizmoMode_Scale;
+			resetId();
+		}
+		if (wasKeyPressed(Action_GizmoLocal))
+		{
+			m_gizmoLocal = !m_gizmoLocal;
+			resetId();
 		}
-		m_cullFrustum[m_cullFrustumCount++] = plane;
 	}
 
- // update gizmo modes
-	if (wasKeyPressed(Action_GizmoTranslation))
+	m_appIdActivated = Id_Invalid;
+
+	#if IM3D_THREAD_SAFE_SUBMISSION
+		if (!m_producerParent)
+		{
+			m_ownerThread = GetThreadTag();
+			++m_frameIndex;
+			#if IM3D_PRODUCER_IDLE_FRAMES > 0
+			 // destroy producers which weren't requested recently (e.g. their thread exited), else they would be merged and synced every
+			 // frame; threads which cached a destroyed producer resolve a new one because m_producerGeneration changes
+				for (Context** link = &m_producerHead; *link; )
+				{
+					Context* producer = *link;
+					if (m_frameIndex - producer->m_producerLastFrame > IM3D_PRODUCER_IDLE_FRAMES)
+					{
+						*link = producer->m_producerNext;
+						producer->~Context(); // see ~Context()
+						IM3D_FREE(producer);
+						++m_producerGeneration;
+					}
+					else
+					{
+						link = &producer->m_producerNext;
+					}
+				}
+			#endif
+			if (m_textInternSharedVersion != m_textInternVersion)
+			{
+			 // producers created during the frame copy the interned strings from here, m_textBuffer may be reallocated concurrently
+				m_textInternSharedText.clear();
+				m_textInternSharedText.append(m_textBuffer.data(), m_textInternSize);
+				m_textInternSharedTable.clear();
+				m_textInternSharedTable.append(m_textIntern);
+				m_textInternSharedSlots.clear();
+				m_textInternSharedSlots.append(m_textInternSlots);
+				m_textInternSharedVersion = m_textInternVersion;
+			}
+			for (Context* producer = m_producerHead; producer; producer = producer->m_producerNext)
+			{
+				syncProducer(*producer);
+			}
+		}
+	#endif
+}
+
+Context& Context::getThreadContext()
+{
+	#if IM3D_THREAD_SAFE_SUBMISSION
+		if (m_producerParent)
+		{
+			return *this;
+		}
+
+		ThreadContextCache& cache = g_ThreadContextCache;
+		if_likely (cache.m_serial == m_serial && cache.m_owner == m_ownerThread && cache.m_generation == m_producerGeneration)
+		{
+			cache.m_context->m_producerLastFrame = m_frameIndex;
+			return *cache.m_context;
+		}
+
+		const void* thread = GetThreadTag();
+		Context* ret = nullptr;
+		if (thread == m_ownerThread)
+		{
+			ret = this;
+		}
+		else
+		{
+			for (Context* producer = IM3D_ATOMIC_LOAD_PTR(&m_producerHead); producer; producer = producer->m_producerNext)
+			{
+				if (producer->m_producerThread == thread)
+				{
+					ret = producer;
+					break;
+				}
+			}
+		}
+
+		if (!ret)
+		{
+		 // first call from this thread, create a producer and push it onto the list; a producer is a full Context rather than bare
+		 // vertex/text blocks because each thread also needs its own state stacks (color, matrix, ID, layer, cull scope) and primitive state
+			ret = new (IM3D_MALLOC(sizeof(Context))) Context();
+			ret->m_producerParent = this;
+			ret->m_producerThread = thread;
+			syncProducer(*ret);
+			do
+			{
+				ret->m_producerNext = IM3D_ATOMIC_LOAD_PTR(&m_producerHead);
+			}
+			while (!IM3D_ATOMIC_CAS_PTR(&m_producerHead, ret->m_producerNext, ret));
+		}
+
+		ret->m_producerLastFrame = m_frameIndex;
+		cache.m_serial     = m_serial;
+		cache.m_owner      = m_ownerThread;
+		cache.m_generation = m_producerGeneration;
+		cache.m_context    = ret;
+		return *ret;
+	#else
+		return *this;
+	#endif
+}
+
+void Context::setFrameConstants(const FrameConstants* _frameConstants)
+{
+	m_frameConstants = _frameConstants ? _frameConstants : &m_localFrameConstants;
+}
+
+void Context::syncProducer(Context& _producer_)
+{
+	IM3D_ASSERT(_producer_.m_producerParent == this);
+	_producer_.m_frameConstants    = m_frameConstants; // producers share the parent's frame constants
+	_producer_.m_gizmoLocal        = m_gizmoLocal;
+	_producer_.m_gizmoMode         = m_gizmoMode;
+	_producer_.m_gizmoHeightPixels = m_gizmoHeightPixels;
+	_producer_.m_gizmoSizePixels   = m_gizmoSizePixels;
+	if (m_deferHot)
 	{
-		m_gizmoMode = GizmoMode_Translation;
-		resetId();
+	 // producers evaluate gizmos against the resolved hot/active state, see merge()
+		_producer_.m_hotId             = m_hotId;
+		_producer_.m_appHotId          = m_appHotId;
+		_producer_.m_hotDepth          = m_hotDepth;
+		_producer_.m_activeId          = m_activeId;
+		_producer_.m_appActiveId       = m_appActiveId;
+		_producer_.m_gizmoStateVec3    = m_gizmoStateVec3;
+		_producer_.m_gizmoStateMat3    = m_gizmoStateMat3;
+		_producer_.m_gizmoStateFloat   = m_gizmoStateFloat;
 	}
-	else if (wasKeyPressed(Action_GizmoRotation))
+	for (U32 i = 0; i < m_layerIdMap.size(); ++i)
 	{
-		m_gizmoMode = GizmoMode_Rotation;
-		resetId();
+		_producer_.setLayerPolicy(m_layerIdMap[i], m_layerPolicies[i]);
 	}
-	else if (wasKeyPressed(Action_GizmoScale))
+	_producer_.m_views.clear(); // for estimateLevelOfDetail(), producers don't build view draw lists
+	_producer_.m_views.append(m_views);
+	if (_producer_.m_textInternSharedVersion != m_textInternSharedVersion)
 	{
-		m_gizmoMode = GizmoMode_Scale;
-		resetId();
+	 // copy the interned strings, text() on a producer never reads the parent's table (which the owner thread may modify)
+		_producer_.m_textBuffer.clear();
+		_producer_.m_textBuffer.append(m_textInternSharedText);
+		_producer_.m_textIntern.clear();
+		_producer_.m_textIntern.append(m_textInternSharedTable);
+		_producer_.m_textInternSlots.clear();
+		_producer_.m_textInternSlots.append(m_textInternSharedSlots);
+		_producer_.m_textInternSize = m_textInternSharedText.size();
+		_producer_.m_textInternDirty = false;
+		_producer_.m_textInternSharedVersion = m_textInternSharedVersion;
 	}
-	if (wasKeyPressed(Action_GizmoLocal))
+	_producer_.reset();
+	_producer_.m_deferHot = m_deferHot; // producers don't reference m_interactionState
+}
+
+void Context::submitHotCandidate()
+{
+	if (!m_interactionState || m_hotCandidateId == Id_Invalid)
 	{
-		m_gizmoLocal = !m_gizmoLocal;
-		resetId();
+		return;
 	}
 
-	m_appIdActivated = Id_Invalid;
+ // pack such that nearer candidates compare less (negative depths have their bits flipped), ties resolve to the lowest serial
+	U32 depthBits;
+	memcpy(&depthBits, &m_hotCandidateDepth, sizeof(depthBits));
+	depthBits = (depthBits & 0x80000000u) ? ~depthBits : (depthBits | 0x80000000u);
+	const U64 candidate = ((U64)depthBits << 32) | (U64)m_serial;
+
+	U64 current = IM3D_ATOMIC_LOAD_U64(&m_interactionState->m_hotCandidate);
+	while (candidate < current && !IM3D_ATOMIC_CAS_U64(&m_interactionState->m_hotCandidate, current, candidate))
+	{
+		current = IM3D_ATOMIC_LOAD_U64(&m_interactionState->m_hotCandidate);
+	}
 }
 
 void Context::merge(const Context& _src)
 {
 	IM3D_ASSERT(!m_endFrameCalled && !_src.m_endFrameCalled); // call MergeContexts() before calling EndFrame()
 
+ // primitives culled during submission (e.g. by producer contexts)
+	for (int i = 0; i < DrawPrimitive_Count; ++i)
+	{
+		m_culledPrimitiveCount[i] += _src.m_culledPrimitiveCount[i];
+	}
+
+ // nearest picked volume
+	if (_src.m_pickDepth < m_pickDepth)
+	{
+		m_pickId = _src.m_pickId;
+		m_pickDepth = _src.m_pickDepth;
+	}
+
+ // nearest hot candidate and activation changes (deferred hot resolution)
+	if (m_deferHot)
+	{
+		if (_src.m_hotCandidateDepth < m_hotCandidateDepth)
+		{
+			m_hotCandidateId = _src.m_hotCandidateId;
+			m_appHotCandidateId = _src.m_appHotCandidateId;
+			m_hotCandidateDepth = _src.m_hotCandidateDepth;
+		}
+		if (_src.m_activeId != _src.m_activeIdAtReset)
+		{
+		 // _src activated or released a gizmo this frame; the stored gizmo state only changes on activation
+			m_activeId = _src.m_activeId;
+			m_appActiveId = _src.m_appActiveId;
+			m_appIdActivated = _src.m_appIdActivated;
+			m_hotId = _src.m_hotId;
+			m_appHotId = _src.m_appHotId;
+			m_gizmoStateVec3 = _src.m_gizmoStateVec3;
+			m_gizmoStateMat3 = _src.m_gizmoStateMat3;
+			m_gizmoStateFloat = _src.m_gizmoStateFloat;
+		}
+	}
+
  // layer IDs
 	for (Id id : _src.m_layerIdMap)
 	{
@@ -1940,20 +3141,42 @@ void Context::merge(const Context& _src)
 		}
 	}
 
- // text data
+ // text data - the text buffer is shared by all layers, copy the range referenced by any layer once and offset the text data for each
+ // layer (the range excludes unreferenced interned strings)
+	U32 textBegin = _src.m_textBuffer.size();
+	U32 textEnd = 0;
+	for (const TextList* srcTextList : _src.m_textData)
+	{
+		for (const TextData& td : *srcTextList)
+		{
+			textBegin = td.m_textBufferOffset < textBegin ? td.m_textBufferOffset : textBegin;
+			textEnd = td.m_textBufferOffset + td.m_textLength + 1 > textEnd ? td.m_textBufferOffset + td.m_textLength + 1 : textEnd;
+		}
+	}
+	if (textBegin >= textEnd)
+	{
+		return; // no text
+	}
+	const U32 textBufferOffset = m_textBuffer.size() - textBegin;
+	m_textBuffer.append(_src.m_textBuffer.data() + textBegin, textEnd - textBegin);
 	for (U32 i = 0; i < _src.m_textData.size(); ++i)
 	{
+		const TextList& srcTextList = *_src.m_textData[i];
+		if (srcTextList.empty())
+		{
+			continue;
+		}
+
 		const Id layerId = _src.m_layerIdMap[i];
 		const int layerIndex = findLayerIndex(layerId);
 		IM3D_ASSERT(layerIndex >= 0);
 
-		const U32 textBufferOffset = m_textBuffer.size();
-		m_textBuffer.append(_src.m_textBuffer);
-		const auto& textList = _src.m_textData[i];
-		for (U32 j = 0; j < textList->size(); ++j)
+		TextList& dstTextList = *m_textData[layerIndex];
+		const U32 first = dstTextList.size();
+		dstTextList.append(srcTextList);
+		for (U32 j = first; j < dstTextList.size(); ++j)
 		{
-			m_textData[i]->push_back((*_src.m_textData[i])[j]);
-			m_textData[i]->back().m_textBufferOffset += textBufferOffset;
+			dstTextList[j].m_textBufferOffset += textBufferOffset;
 		}
 	}
 }
@@ -1961,8 +3184,56 @@ void Context::merge(const Context& _src)
 void Context::endFrame()
 {
 	IM3D_ASSERT(!m_endFrameCalled); // EndFrame() was called multiple times for this frame
+
+	#if IM3D_THREAD_SAFE_SUBMISSION
+	 // gather data from the per-thread producers; the app must ensure that no other thread is submitting
+		for (Context* producer = m_producerHead; producer; producer = producer->m_producerNext)
+		{
+			merge(*producer);
+		}
+	#endif
+
 	m_endFrameCalled = true;
 
+ // the nearest candidate from all gizmos this frame becomes hot for the next frame, the active gizmo stays hot
+	if (m_interactionState)
+	{
+	 // submit to the shared state, which is resolved by InteractionState::resolve(); producer candidates may have been merged above
+		submitHotCandidate();
+		if (m_hotCandidateId != Id_Invalid || m_activeId != m_activeIdAtReset)
+		{
+			do
+			{
+				m_interactionNext = IM3D_ATOMIC_LOAD_PTR(&m_interactionState->m_submitted);
+			}
+			while (!IM3D_ATOMIC_CAS_PTR(&m_interactionState->m_submitted, m_interactionNext, this));
+		}
+	}
+	else if (m_deferHot && m_activeId == Id_Invalid)
+	{
+		m_hotId = m_hotCandidateId;
+		m_appHotId = m_appHotCandidateId;
+		m_hotDepth = m_hotCandidateDepth;
+	}
+
+ // gizmos take priority over picked volumes
+	if (m_hotId != Id_Invalid || m_activeId != Id_Invalid)
+	{
+		m_pickId = Id_Invalid;
+		m_pickDepth = FLT_MAX;
+	}
+
+	#if IM3D_COMPACT_PRIMITIVES
+		compactPrimitives();
+	#endif
+	#if IM3D_CULL_PRIMITIVES_POST_PASS
+		cullPrimitives();
+	#endif
+	if (getAppData().m_occlusionBuffer)
+	{
+		occludePrimitives();
+	}
+
  // draw unsorted primitives first
 	for (U32 i = 0; i < m_vertexData[0].size(); ++i)
 	{
@@ -1982,6 +3253,10 @@ void Context::endFrame()
 		sort();
 	}
 
+	if (IM3D_CULL_TEXT || getAppData().m_textDeclutterSize > 0.0f)
+	{
+		cullText();
+	}
 	for (U32 i = 0; i < m_textData.size(); ++i) {
 		if (m_textData[i]->size() > 0)
 		{
@@ -1992,6 +3267,251 @@ void Context::endFrame()
 			dl.m_textBuffer    = m_textBuffer.data();
 		}
 	}
+	if (getAppData().m_font)
+	{
+		layoutText();
+	}
+
+	if (!m_views.empty())
+	{
+		buildViewDrawLists();
+	}
+}
+
+void Context::cullText()
+{
+	const AppData& appData = getAppData();
+	const float cellSize = appData.m_textDeclutterSize;
+
+	for (U32 layer = 0; layer < m_textData.size(); ++layer)
+	{
+		TextList& textList = *m_textData[layer];
+		if (textList.empty())
+		{
+			continue;
+		}
+
+	 // open addressing hash table, cell key -> index + clip w of the nearest text in the cell (~0 = empty)
+		U32 cellMask = 0;
+		if (cellSize > 0.0f)
+		{
+			U32 cellCount = 16;
+			while (cellCount < textList.size() * 2)
+			{
+				cellCount *= 2;
+			}
+			cellMask = cellCount - 1;
+			m_textDeclutterCells.resize(cellCount * 3);
+			memset(m_textDeclutterCells.data(), 0xff, cellCount * 3 * sizeof(U32));
+		}
+
+	 // rejected text has its bit cleared in m_textKeep (text may legitimately have size 0)
+		const U32 keepWords = (textList.size() + 31) / 32;
+		m_textKeep.resize(keepWords);
+		memset(m_textKeep.data(), 0xff, keepWords * sizeof(U32));
+		for (U32 i = 0; i < textList.size(); ++i)
+		{
+			TextData& textData = textList[i];
+			const Vec3 position = Vec3(textData.m_positionSize);
+			#if IM3D_CULL_TEXT
+				if (!isVisible(position, 0.0f))
+				{
+					m_textKeep[i / 32] &= ~(1u << (i % 32));
+					continue;
+				}
+			#endif
+			if (cellSize == 0.0f)
+			{
+				continue;
+			}
+
+			const Vec4 clip = appData.m_viewProj * Vec4(position, 1.0f);
+			if (clip.w <= 0.0f) // behind the view
+			{
+				m_textKeep[i / 32] &= ~(1u << (i % 32));
+				continue;
+			}
+			const int cellX = (int)floorf((clip.x / clip.w * 0.5f + 0.5f) * appData.m_viewportSize.x / cellSize);
+			const int cellY = (int)floorf((clip.y / clip.w * 0.5f + 0.5f) * appData.m_viewportSize.y / cellSize);
+			const U32 key = ((U32)cellY << 16) | ((U32)cellX & 0xffffu);
+			for (U32 slot = (key * 2654435761u) & cellMask;; slot = (slot + 1) & cellMask)
+			{
+				U32* cell = m_textDeclutterCells.data() + slot * 3;
+				if (cell[1] == ~0u)
+				{
+					cell[0] = key;
+					cell[1] = i;
+					memcpy(&cell[2], &clip.w, sizeof(float));
+					break;
+				}
+				if (cell[0] == key)
+				{
+				 // nearest text wins, ties are resolved in submission order
+					float otherW;
+					memcpy(&otherW, &cell[2], sizeof(float));
+					if (clip.w < otherW)
+					{
+						m_textKeep[cell[1] / 32] &= ~(1u << (cell[1] % 32));
+						cell[1] = i;
+						memcpy(&cell[2], &clip.w, sizeof(float));
+					}
+					else
+					{
+						m_textKeep[i / 32] &= ~(1u << (i % 32));
+					}
+					break;
+				}
+			}
+		}
+
+	 // compact in place, preserving submission order
+		U32 count = 0;
+		for (U32 i = 0; i < textList.size(); ++i)
+		{
+			if (m_textKeep[i / 32] & (1u << (i % 32)))
+			{
+				textList[count++] = textList[i];
+			}
+		}
+		m_culledTextCount += textList.size() - count;
+		textList.resize(count);
+	}
+}
+
+void Context::layoutText()
+{
+	const Font& font = *getAppData().m_font;
+	IM3D_ASSERT(font.m_glyphs || font.m_glyphCount == 0);
+
+ // count glyph quads first so that m_textVertexData is allocated once and the quad list pointers remain valid
+	U32 quadCount = 0;
+	for (const TextDrawList& textDrawList : m_textDrawLists)
+	{
+		for (U32 i = 0; i < textDrawList.m_textDataCount; ++i)
+		{
+			const TextData& textData = textDrawList.m_textData[i];
+			const char* text = textDrawList.m_textBuffer + textData.m_textBufferOffset;
+			for (U32 j = 0; j < textData.m_textLength; ++j)
+			{
+				const U32 glyphIndex = (U32)(unsigned char)text[j] - font.m_firstChar; // wraps for characters below m_firstChar
+				quadCount += (glyphIndex < font.m_glyphCount && font.m_glyphs[glyphIndex].m_size.x > 0.0f) ? 1 : 0;
+			}
+		}
+	}
+	m_textVertexData.reserve(quadCount * 6);
+
+	for (const TextDrawList& textDrawList : m_textDrawLists)
+	{
+		const U32 firstVertex = m_textVertexData.size();
+		for (U32 i = 0; i < textDrawList.m_textDataCount; ++i)
+		{
+			const TextData& textData = textDrawList.m_textData[i];
+			const float scale = textData.m_positionSize.w;
+			if (scale == 0.0f || textData.m_color.getA() == 0.0f)
+			{
+				continue;
+			}
+			const Vec3  position = Vec3(textData.m_positionSize.x, textData.m_positionSize.y, textData.m_positionSize.z);
+			const char* text     = textDrawList.m_textBuffer + textData.m_textBufferOffset;
+			const char* textEnd  = text + textData.m_textLength;
+
+		 // measure the text block
+			U32   lineCount = 1;
+			float lineWidth = 0.0f;
+			float blockWidth = 0.0f;
+			for (const char* c = text; c != textEnd; ++c)
+			{
+				if (*c == '\n')
+				{
+					blockWidth = Max(blockWidth, lineWidth);
+					lineWidth = 0.0f;
+					++lineCount;
+					continue;
+				}
+				const U32 glyphIndex = (U32)(unsigned char)*c - font.m_firstChar;
+				lineWidth += glyphIndex < font.m_glyphCount ? font.m_glyphs[glyphIndex].m_advance : 0.0f;
+			}
+			blockWidth = Max(blockWidth, lineWidth) * scale;
+			const float lineHeight = font.m_lineHeight * scale;
+			const float blockHeight = lineHeight * (float)lineCount;
+
+		 // alignment matches TextFlags semantics, e.g. AlignLeft places the text to the left of the anchor
+			float penY = -blockHeight * 0.5f; // default to center
+			if ((textData.m_flags & TextFlags_AlignTop) != 0)
+			{
+				penY = -blockHeight;
+			}
+			else if ((textData.m_flags & TextFlags_AlignBottom) != 0)
+			{
+				penY = 0.0f;
+			}
+
+			for (const char* line = text; line <= textEnd; penY += lineHeight)
+			{
+				const char* lineEnd = line;
+				lineWidth = 0.0f;
+				for (; lineEnd != textEnd && *lineEnd != '\n'; ++lineEnd)
+				{
+					const U32 glyphIndex = (U32)(unsigned char)*lineEnd - font.m_firstChar;
+					lineWidth += glyphIndex < font.m_glyphCount ? font.m_glyphs[glyphIndex].m_advance : 0.0f;
+				}
+				lineWidth *= scale;
+
+			 // each line is aligned individually
+				float penX = -lineWidth * 0.5f;
+				if ((textData.m_flags & TextFlags_AlignLeft) != 0)
+				{
+					penX = -lineWidth;
+				}
+				else if ((textData.m_flags & TextFlags_AlignRight) != 0)
+				{
+					penX = 0.0f;
+				}
+
+				for (const char* c = line; c != lineEnd; ++c)
+				{
+					const U32 glyphIndex = (U32)(unsigned char)*c - font.m_firstChar;
+					if (glyphIndex >= font.m_glyphCount)
+					{
+						continue;
+					}
+					const FontGlyph& glyph = font.m_glyphs[glyphIndex];
+					if (glyph.m_size.x > 0.0f)
+					{
+						const Vec2 q0 = Vec2(penX, penY) + glyph.m_offset * scale;
+						const Vec2 q1 = q0 + glyph.m_size * scale;
+						const Vec2 corners[6][2] =
+						{
+							{ q0,                   glyph.m_uvMin },
+							{ Vec2(q1.x, q0.y),     Vec2(glyph.m_uvMax.x, glyph.m_uvMin.y) },
+							{ q1,                   glyph.m_uvMax },
+							{ q0,                   glyph.m_uvMin },
+							{ q1,                   glyph.m_uvMax },
+							{ Vec2(q0.x, q1.y),     Vec2(glyph.m_uvMin.x, glyph.m_uvMax.y) },
+						};
+						for (int k = 0; k < 6; ++k)
+						{
+							TextVertex& v = m_textVertexData.push_back();
+							v.m_position  = position;
+							v.m_offset    = corners[k][0];
+							v.m_uv        = corners[k][1];
+							v.m_color     = textData.m_color;
+						}
+					}
+					penX += glyph.m_advance * scale;
+				}
+				line = lineEnd + 1;
+			}
+		}
+
+		if (m_textVertexData.size() > firstVertex)
+		{
+			TextQuadList& ql = m_textQuadLists.push_back();
+			ql.m_layerId     = textDrawList.m_layerId;
+			ql.m_vertexData  = m_textVertexData.data() + firstVertex;
+			ql.m_vertexCount = m_textVertexData.size() - firstVertex;
+		}
+	}
 }
 
 void Context::draw()
@@ -2001,10 +3521,10 @@ void Context::draw()
 		endFrame();
 	}
 
-	IM3D_ASSERT(m_appData.drawCallback);
+	IM3D_ASSERT(getAppData().drawCallback);
 	for (auto& drawList : m_drawLists)
 	{
-		m_appData.drawCallback(drawList);
+		getAppData().drawCallback(drawList);
 	}
 }
 
@@ -2044,6 +3564,7 @@ void Context::pushLayerId(Id _layer)
 		}
 		m_textData.push_back((TextList*)IM3D_MALLOC(sizeof(TextList)));
 		*m_textData.back() = TextList();
+		m_layerPolicies.push_back(LayerPolicy());
 	}
 	m_layerIdStack.push_back(_layer);
 	m_layerIndex = idx;
@@ -2055,6 +3576,45 @@ void Context::popLayerId()
 	m_layerIndex = findLayerIndex(m_layerIdStack.back());
 }
 
+void Context::pushCullBounds(const Vec3& _min, const Vec3& _max)
+{
+	IM3D_ASSERT(m_primMode == PrimitiveMode_None); // can't change cull scope mid-primitive
+	m_cullScopeCulled = m_cullScopeCulled || !isVisible(_min, _max); // nested scopes inherit the result
+	m_cullScopeStack.push_back(m_cullScopeCulled);
+}
+void Context::pushCullSphere(const Vec3& _origin, float _radius)
+{
+	IM3D_ASSERT(m_primMode == PrimitiveMode_None); // can't change cull scope mid-primitive
+	m_cullScopeCulled = m_cullScopeCulled || !isVisible(_origin, _radius);
+	m_cullScopeStack.push_back(m_cullScopeCulled);
+}
+void Context::popCullBounds()
+{
+	IM3D_ASSERT(m_primMode == PrimitiveMode_None); // can't change cull scope mid-primitive
+	IM3D_ASSERT(m_cullScopeStack.size() > 1);
+	m_cullScopeStack.pop_back();
+	m_cullScopeCulled = m_cullScopeStack.back();
+}
+
+void Context::setLayerPolicy(Id _layerId, const LayerPolicy& _policy)
+{
+	int idx = findLayerIndex(_layerId);
+	if (idx == -1)
+	{
+		pushLayerId(_layerId); // add the layer
+		popLayerId();
+		idx = findLayerIndex(_layerId);
+	}
+	m_layerPolicies[idx] = _policy;
+}
+
+const LayerPolicy& Context::getLayerPolicy(Id _layerId) const
+{
+	static const LayerPolicy s_defaultPolicy;
+	const int idx = findLayerIndex(_layerId);
+	return idx == -1 ? s_defaultPolicy : m_layerPolicies[idx];
+}
+
 Context::Context()
 {
 	m_sortCalled = false;
@@ -2064,6 +3624,8 @@ Context::Context()
 	m_layerIndex = 0;
 	m_firstVertThisPrim = 0;
 	m_vertCountThisPrim = 0;
+	memset(m_culledPrimitiveCount, 0, sizeof(m_culledPrimitiveCount));
+	m_culledTextCount = 0;
 
 	m_gizmoLocal = false;
 	m_gizmoMode = GizmoMode_Translation;
@@ -2073,11 +3635,34 @@ Context::Context()
 	m_appActiveId = Id_Invalid;
 	m_appHotId = Id_Invalid;
 	m_hotDepth = FLT_MAX;
+	m_pickId = Id_Invalid;
+	m_pickDepth = FLT_MAX;
+	m_hotCandidateId = Id_Invalid;
+	m_appHotCandidateId = Id_Invalid;
+	m_hotCandidateDepth = FLT_MAX;
+	m_activeIdAtReset = Id_Invalid;
+	m_deferHot = false;
+	m_interactionState = nullptr;
+	m_interactionNext = nullptr;
 	m_gizmoHeightPixels = 64.0f;
 	m_gizmoSizePixels = 5.0f;
 
-	memset(&m_keyDownCurr, 0, sizeof(m_keyDownCurr));
-	memset(&m_keyDownPrev, 0, sizeof(m_keyDownPrev));
+	#if IM3D_THREAD_SAFE_SUBMISSION
+		m_serial = IM3D_ATOMIC_INC_U32(&g_ContextSerial);
+	#else
+		m_serial = ++g_ContextSerial;
+	#endif
+	m_ownerThread = nullptr;
+	m_producerThread = nullptr;
+	m_producerParent = nullptr;
+	m_producerNext = nullptr;
+	m_producerHead = nullptr;
+	m_producerLastFrame = 0;
+	m_producerGeneration = 0;
+	m_frameIndex = 0;
+
+	m_localFrameConstants.m_appData = &m_appData;
+	m_frameConstants = &m_localFrameConstants;
 
  // init cull frustum to INF effectively disables culling
 	for (int i = 0; i < FrustumPlane_Count; ++i)
@@ -2091,11 +3676,27 @@ Context::Context()
 	pushSize(1.0f);
 	pushEnableSorting(false);
 	pushLayerId(0);
-	pushId(0x811C9DC5u); // fnv1 hash base
+	m_cullScopeStack.push_back(false);
+	m_cullScopeCulled = false;
+	m_textInternSize = 0;
+	m_textInternDirty = false;
+	m_textInternVersion = 0;
+	m_textInternSharedVersion = 0;
+	m_discardThisPrim = false;
+	m_fadeThisPrim = false;
+	pushId(internal::kFnv1aBase32);
 }
 
 Context::~Context()
 {
+	while (m_producerHead)
+	{
+		Context* producer = m_producerHead;
+		m_producerHead = producer->m_producerNext;
+		producer->~Context(); // manually call dtor (producer is allocated via IM3D_MALLOC during getThreadContext)
+		IM3D_FREE(producer);
+	}
+
 	for (int i = 0; i < 2; ++i)
 	{
 		while (!m_vertexData[i].empty())
@@ -2112,6 +3713,13 @@ Context::~Context()
 		IM3D_FREE(m_textData.back());
 		m_textData.pop_back();
 	}
+
+	while (!m_viewVertexData.empty())
+	{
+		m_viewVertexData.back()->~Vector(); // see above
+		IM3D_FREE(m_viewVertexData.back());
+		m_viewVertexData.pop_back();
+	}
 }
 
 namespace {
@@ -2162,7 +3770,7 @@ void Context::sort()
 
 	for (U32 layer = 0; layer < m_layerIdMap.size(); ++layer)
 	{
-		Vec3 viewOrigin = m_appData.m_viewOrigin;
+		Vec3 viewOrigin = getAppData().m_viewOrigin;
 
 	 // sort each primitive list internally
 		for (int i = 0 ; i < DrawPrimitive_Count; ++i)
@@ -2211,52 +3819,297 @@ void Context::sort()
 		{
 			while (search[cprim] == 0)
 			{
-				cprim = modinc(cprim);
+				cprim = modinc(cprim);
+			}
+
+		 // find the max key at the current position across all sort data
+			float mxkey = search[cprim]->m_key;
+			int mxprim = cprim;
+			for (int p = modinc(cprim); p != cprim; p = modinc(p))
+			{
+				if (search[p] != 0 && search[p]->m_key > mxkey)
+				{
+					mxkey = search[p]->m_key;
+					mxprim = p;
+				}
+			}
+
+		 // if draw list is empty or the layer or primitive changed, start a new draw list
+			if (false
+				|| first
+				|| (m_drawLists.back().m_layerId  != m_layerIdMap[layer])
+				|| (m_drawLists.back().m_primType != mxprim)
+				)
+			{
+				cprim = mxprim;
+				DrawList dl;
+				dl.m_layerId     = m_layerIdMap[layer];
+				dl.m_primType    = (DrawPrimitiveType)cprim;
+				dl.m_vertexData  = m_vertexData[1][layer * DrawPrimitive_Count + cprim]->data() + (search[cprim] - sortData[cprim].data()) * VertsPerDrawPrimitive[cprim];
+				dl.m_vertexCount = 0;
+				m_drawLists.push_back(dl);
+				first = false;
+			}
+
+		 // increment the vertex count for the current draw list
+			m_drawLists.back().m_vertexCount += VertsPerDrawPrimitive[cprim];
+			++search[cprim];
+			if (search[cprim] == sortData[cprim].end())
+			{
+				search[cprim] = 0;
+				++emptyCount;
+			}
+
+		}
+		#undef modinc
+	}
+
+	m_sortCalled = true;
+}
+
+void Context::setViews(const View* _views, U32 _count)
+{
+	m_views.clear();
+	m_views.append(_views, _count);
+}
+
+namespace {
+	// Cull frustum for a View, see FrameConstants::update().
+	struct ViewFrustum
+	{
+		Vec4 m_planes[FrustumPlane_Count];
+		int  m_count;
+
+		ViewFrustum(const View& _view)
+		{
+			m_count = 0;
+			for (int i = 0; i < FrustumPlane_Count; ++i)
+			{
+				const Vec4& plane = _view.m_cullFrustum[i];
+				if ((_view.m_projOrtho && i == FrustumPlane_Near) || std::isinf(plane.w) || Length2(Vec3(plane)) == 0.0f)
+				{
+					continue;
+				}
+				m_planes[m_count++] = plane;
+			}
+		}
+
+		// See Context::isVisible(const VertexData*, DrawPrimitiveType).
+		bool isVisible(const View& _view, const VertexData* _vdata, DrawPrimitiveType _prim) const
+		{
+			Vec3  pos[3];
+			float size[3];
+			for (int i = 0; i < VertsPerDrawPrimitive[_prim]; ++i)
+			{
+				pos[i] = Vec3(_vdata[i].m_positionSize);
+				if (_prim == DrawPrimitive_Triangles)
+				{
+					size[i] = 0.0f;
+				}
+				else
+				{
+					const float d = _view.m_projOrtho ? 1.0f : Length(pos[i] - _view.m_viewOrigin);
+					size[i] = _view.m_projScaleY * d * (_vdata[i].m_positionSize.w / _view.m_viewportSize.y);
+				}
+			}
+			for (int i = 0; i < m_count; ++i)
+			{
+				bool isVisible = false;
+				for (int j = 0; j < VertsPerDrawPrimitive[_prim]; ++j)
+				{
+					isVisible |= Distance(m_planes[i], pos[j]) > -size[j];
+				}
+				if (!isVisible)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+}
+
+void Context::buildViewDrawLists()
+{
+	static IM3D_THREAD_LOCAL Vector<SortData> sortData[DrawPrimitive_Count]; // reduces # allocs
+	static IM3D_THREAD_LOCAL Vector<U32> visibleBits;                         // 1 bit per primitive in m_vertexData[0], m_vertexData[1]
+	static IM3D_THREAD_LOCAL Vector<U32> visibleCounts;                       // # visible vertices per list in m_vertexData[0], m_vertexData[1]
+
+	while (m_viewVertexData.size() < m_views.size())
+	{
+		m_viewVertexData.push_back((VertexList*)IM3D_MALLOC(sizeof(VertexList)));
+		*m_viewVertexData.back() = VertexList();
+	}
+
+	m_viewDrawLists.clear();
+	m_viewDrawListStart.clear();
+	for (U32 viewIndex = 0; viewIndex < m_views.size(); ++viewIndex)
+	{
+		const View& view = m_views[viewIndex];
+		const ViewFrustum frustum(view);
+		VertexList& viewVertexData = *m_viewVertexData[viewIndex];
+		viewVertexData.clear();
+		m_viewDrawListStart.push_back(m_viewDrawLists.size());
+
+	 // gathered vertices are appended to a per-view list which must not grow while draw lists point into it; cull all primitives first
+	 // to reserve exactly the vertices this view copies, the passes below read the visibility bits instead of testing again
+		visibleBits.clear();
+		visibleCounts.clear();
+		U32 bit = 0;
+		U32 copyCount = 0;
+		for (int sorted = 0; sorted < 2; ++sorted)
+		{
+			for (U32 i = 0; i < m_vertexData[sorted].size(); ++i)
+			{
+				const VertexList& vertexList = *m_vertexData[sorted][i];
+				const DrawPrimitiveType primType = (DrawPrimitiveType)(i % DrawPrimitive_Count);
+				const int vertsPerPrim = VertsPerDrawPrimitive[primType];
+				U32 visibleCount = 0;
+				for (const VertexData* v = vertexList.begin(); v != vertexList.end(); v += vertsPerPrim, ++bit)
+				{
+					if (bit % 32 == 0)
+					{
+						visibleBits.push_back(0);
+					}
+					if (frustum.isVisible(view, v, primType))
+					{
+						visibleBits.back() |= 1u << (bit % 32);
+						visibleCount += vertsPerPrim;
+					}
+				}
+				visibleCounts.push_back(visibleCount);
+				if (sorted || visibleCount != vertexList.size()) // fully visible unsorted lists reference the shared vertex data
+				{
+					copyCount += visibleCount;
+				}
+			}
+		}
+		viewVertexData.reserve(copyCount);
+		bit = 0;
+
+	 // unsorted primitives first, lists with no culled primitives reference the shared vertex data directly
+		for (U32 i = 0; i < m_vertexData[0].size(); ++i)
+		{
+			const VertexList& vertexList = *m_vertexData[0][i];
+			if (vertexList.empty())
+			{
+				continue;
+			}
+			const DrawPrimitiveType primType = (DrawPrimitiveType)(i % DrawPrimitive_Count);
+			const int vertsPerPrim = VertsPerDrawPrimitive[primType];
+			const U32 primCount = vertexList.size() / vertsPerPrim;
+			DrawList dl;
+			dl.m_layerId     = m_layerIdMap[i / DrawPrimitive_Count];
+			dl.m_primType    = primType;
+			dl.m_vertexData  = vertexList.data();
+			dl.m_vertexCount = visibleCounts[i];
+			if (dl.m_vertexCount != vertexList.size())
+			{
+				dl.m_vertexData = viewVertexData.end();
+				for (U32 j = 0; j < primCount; ++j)
+				{
+					if (visibleBits[(bit + j) / 32] & (1u << ((bit + j) % 32)))
+					{
+						viewVertexData.append(vertexList.data() + j * vertsPerPrim, vertsPerPrim);
+					}
+				}
+			}
+			bit += primCount;
+			if (dl.m_vertexCount > 0)
+			{
+				m_viewDrawLists.push_back(dl);
 			}
+		}
 
-		 // find the max key at the current position across all sort data
-			float mxkey = search[cprim]->m_key;
-			int mxprim = cprim;
-			for (int p = modinc(cprim); p != cprim; p = modinc(p))
+	 // sorted primitives second; the sort data is a permutation of the visible primitives which is resolved by gathering vertices into
+	 // viewVertexData, draw lists are partitioned as per sort()
+		for (U32 layer = 0; layer < m_layerIdMap.size(); ++layer)
+		{
+			for (int i = 0; i < DrawPrimitive_Count; ++i)
 			{
-				if (search[p] != 0 && search[p]->m_key > mxkey)
+				Vector<VertexData>& vertexData = *(m_vertexData[1][layer * DrawPrimitive_Count + i]);
+				const int vertsPerPrim = VertsPerDrawPrimitive[i];
+				sortData[i].clear();
+				for (VertexData* v = vertexData.begin(); v != vertexData.end(); v += vertsPerPrim, ++bit)
 				{
-					mxkey = search[p]->m_key;
-					mxprim = p;
+					if (!(visibleBits[bit / 32] & (1u << (bit % 32))))
+					{
+						continue;
+					}
+					float key = 0.0f;
+					for (int j = 0; j < vertsPerPrim; ++j)
+					{
+						key += Length2(Vec3(v[j].m_positionSize) - view.m_viewOrigin);
+					}
+					sortData[i].push_back(SortData(key / (float)vertsPerPrim, v));
+				}
+				if (!sortData[i].empty())
+				{
+					qsort(sortData[i].data(), sortData[i].size(), sizeof(SortData), SortCmp);
 				}
 			}
 
-		 // if draw list is empty or the layer or primitive changed, start a new draw list
-			if (false
-				|| first
-				|| (m_drawLists.back().m_layerId  != m_layerIdMap[layer])
-				|| (m_drawLists.back().m_primType != mxprim)
-				)
+			const SortData* search[DrawPrimitive_Count];
+			int emptyCount = 0;
+			for (int i = 0; i < DrawPrimitive_Count; ++i)
 			{
-				cprim = mxprim;
-				DrawList dl;
-				dl.m_layerId     = m_layerIdMap[layer];
-				dl.m_primType    = (DrawPrimitiveType)cprim;
-				dl.m_vertexData  = m_vertexData[1][layer * DrawPrimitive_Count + cprim]->data() + (search[cprim] - sortData[cprim].data()) * VertsPerDrawPrimitive[cprim];
-				dl.m_vertexCount = 0;
-				m_drawLists.push_back(dl);
-				first = false;
+				search[i] = sortData[i].empty() ? nullptr : sortData[i].begin();
+				emptyCount += sortData[i].empty() ? 1 : 0;
 			}
-
-		 // increment the vertex count for the current draw list
-			m_drawLists.back().m_vertexCount += VertsPerDrawPrimitive[cprim];
-			++search[cprim];
-			if (search[cprim] == sortData[cprim].end())
+			int currentPrim = -1;
+			while (emptyCount != DrawPrimitive_Count)
 			{
-				search[cprim] = 0;
-				++emptyCount;
-			}
+			 // find the max key at the current position across all sort data
+				int mxprim = -1;
+				for (int p = 0; p < DrawPrimitive_Count; ++p)
+				{
+					if (search[p] && (mxprim == -1 || search[p]->m_key > search[mxprim]->m_key || (p == currentPrim && search[p]->m_key == search[mxprim]->m_key)))
+					{
+						mxprim = p;
+					}
+				}
 
+				if (mxprim != currentPrim)
+				{
+					currentPrim = mxprim;
+					DrawList dl;
+					dl.m_layerId     = m_layerIdMap[layer];
+					dl.m_primType    = (DrawPrimitiveType)mxprim;
+					dl.m_vertexData  = viewVertexData.end();
+					dl.m_vertexCount = 0;
+					m_viewDrawLists.push_back(dl);
+				}
+
+				viewVertexData.append(search[mxprim]->m_start, VertsPerDrawPrimitive[mxprim]);
+				m_viewDrawLists.back().m_vertexCount += VertsPerDrawPrimitive[mxprim];
+				if (++search[mxprim] == sortData[mxprim].end())
+				{
+					search[mxprim] = nullptr;
+					++emptyCount;
+				}
+			}
 		}
-		#undef modinc
+		IM3D_ASSERT(viewVertexData.size() == copyCount);
 	}
+	m_viewDrawListStart.push_back(m_viewDrawLists.size());
+}
 
-	m_sortCalled = true;
+void Context::flushVertexList(int _layerIndex, DrawPrimitiveType _primType)
+{
+	const AppData& appData = getAppData();
+	VertexList& vertexList = *m_vertexData[0][_layerIndex * DrawPrimitive_Count + _primType];
+	if_likely (appData.m_flushVertexCount == 0 || vertexList.size() < appData.m_flushVertexCount || !appData.flushCallback)
+	{
+		return;
+	}
+
+	DrawList dl;
+	dl.m_layerId     = m_layerIdMap[_layerIndex];
+	dl.m_primType    = _primType;
+	dl.m_vertexData  = vertexList.data();
+	dl.m_vertexCount = vertexList.size();
+	appData.flushCallback(dl);
+	vertexList.clear(); // keep the capacity
 }
 
 int Context::findLayerIndex(Id _id) const
@@ -2280,9 +4133,9 @@ bool Context::isVisible(const VertexData* _vdata, DrawPrimitiveType _prim)
 		pos[i]  = Vec3(_vdata[i].m_positionSize);
 		size[i] = _prim == DrawPrimitive_Triangles ? 0.0f : pixelsToWorldSize(pos[i], _vdata[i].m_positionSize.w);
 	}
-	for (int i = 0; i < m_cullFrustumCount; ++i)
+	for (int i = 0; i < m_frameConstants->m_cullFrustumCount; ++i)
 	{
-		const Vec4& plane = m_cullFrustum[i];
+		const Vec4& plane = m_frameConstants->m_cullFrustum[i];
 		bool isVisible= false;
 		for (int j = 0; j < VertsPerDrawPrimitive[_prim]; ++j)
 		{
@@ -2297,11 +4150,38 @@ bool Context::isVisible(const VertexData* _vdata, DrawPrimitiveType _prim)
 	return true;
 }
 
+bool Context::isOccluded(const VertexData* _vdata, DrawPrimitiveType _prim)
+{
+ // bounds expanded by the vertex size, see isVisible()
+	Vec3 bmin = Vec3(FLT_MAX);
+	Vec3 bmax = Vec3(-FLT_MAX);
+	for (int i = 0; i < VertsPerDrawPrimitive[_prim]; ++i)
+	{
+		const Vec3 pos = Vec3(_vdata[i].m_positionSize);
+		const float size = _prim == DrawPrimitive_Triangles ? 0.0f : pixelsToWorldSize(pos, _vdata[i].m_positionSize.w);
+		bmin = Min(bmin, pos - Vec3(size));
+		bmax = Max(bmax, pos + Vec3(size));
+	}
+	return getAppData().m_occlusionBuffer->isOccluded(bmin, bmax);
+}
+
+bool Context::isOccluded(const Vec3& _origin, float _radius)
+{
+	const OcclusionBuffer* occlusionBuffer = getAppData().m_occlusionBuffer;
+	return occlusionBuffer && getLayerPolicy().m_occlusionCulling && occlusionBuffer->isOccluded(_origin, _radius);
+}
+
+bool Context::isOccluded(const Vec3& _min, const Vec3& _max)
+{
+	const OcclusionBuffer* occlusionBuffer = getAppData().m_occlusionBuffer;
+	return occlusionBuffer && getLayerPolicy().m_occlusionCulling && occlusionBuffer->isOccluded(_min, _max);
+}
+
 bool Context::isVisible(const Vec3& _origin, float _radius)
 {
-	for (int i = 0; i < m_cullFrustumCount; ++i)
+	for (int i = 0; i < m_frameConstants->m_cullFrustumCount; ++i)
 	{
-		const Vec4& plane = m_cullFrustum[i];
+		const Vec4& plane = m_frameConstants->m_cullFrustum[i];
 		if (Distance(plane, _origin) < -_radius)
 		{
 			return false;
@@ -2326,9 +4206,9 @@ bool Context::isVisible(const Vec3& _min, const Vec3& _max)
 			Vec3(_min.x, _max.y, _max.z)
 		};
 
- 	for (int i = 0; i < m_cullFrustumCount; ++i)
+ 	for (int i = 0; i < m_frameConstants->m_cullFrustumCount; ++i)
 	{
-		const Vec4& plane = m_cullFrustum[i];
+		const Vec4& plane = m_frameConstants->m_cullFrustum[i];
 		bool inside = false;
 		for (int j = 0; j < 8; ++j)
 		{
@@ -2347,9 +4227,9 @@ bool Context::isVisible(const Vec3& _min, const Vec3& _max)
 
 	return true;
 #else
-	for (int i = 0; i < m_cullFrustumCount; ++i)
+	for (int i = 0; i < m_frameConstants->m_cullFrustumCount; ++i)
 	{
-		const Vec4& plane = m_cullFrustum[i];
+		const Vec4& plane = m_frameConstants->m_cullFrustum[i];
 		float d =
 			Max(_min.x * plane.x, _max.x * plane.x) +
 			Max(_min.y * plane.y, _max.y * plane.y) +
@@ -2367,6 +4247,386 @@ bool Context::isVisible(const Vec3& _min, const Vec3& _max)
 #endif
 }
 
+#if IM3D_SSE
+namespace {
+	// Load 4 consecutive Vec3s and transpose to SoA.
+	inline void LoadVec3x4(const Vec3* _v, __m128& x_, __m128& y_, __m128& z_)
+	{
+		const float* f = &_v->x;
+		__m128 a = _mm_loadu_ps(f);     // x0 y0 z0 x1
+		__m128 b = _mm_loadu_ps(f + 4); // y1 z1 x2 y2
+		__m128 c = _mm_loadu_ps(f + 8); // z2 x3 y3 z3
+		x_ = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		y_ = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		z_ = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+	}
+
+	// Frustum planes splatted to SoA.
+	struct FrustumSoA
+	{
+		__m128 x[FrustumPlane_Count], y[FrustumPlane_Count], z[FrustumPlane_Count], w[FrustumPlane_Count];
+		int    count;
+
+		FrustumSoA(const FrameConstants& _frameConstants)
+		{
+			count = _frameConstants.m_cullFrustumCount;
+			for (int i = 0; i < count; ++i)
+			{
+				const Vec4& plane = _frameConstants.m_cullFrustum[i];
+				x[i] = _mm_set1_ps(plane.x);
+				y[i] = _mm_set1_ps(plane.y);
+				z[i] = _mm_set1_ps(plane.z);
+				w[i] = _mm_set1_ps(plane.w);
+			}
+		}
+	};
+}
+#endif
+
+void Context::isVisible(const Vec3* _origins, const float* _radii, U32 _count, U32* _visible_)
+{
+	memset(_visible_, 0, sizeof(U32) * ((_count + 31) / 32));
+	U32 i = 0;
+
+	#if IM3D_SSE
+	 // 4 spheres per iteration, operations match the scalar path so that the results are identical
+		const FrustumSoA frustum(*m_frameConstants);
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+		for (; i + 4 <= _count; i += 4)
+		{
+			__m128 x, y, z;
+			LoadVec3x4(_origins + i, x, y, z);
+			const __m128 negRadius = _mm_xor_ps(_mm_loadu_ps(_radii + i), signBit);
+			__m128 culled = _mm_setzero_ps();
+			for (int j = 0; j < frustum.count; ++j)
+			{
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(frustum.x[j], x), _mm_mul_ps(frustum.y[j], y)), _mm_mul_ps(frustum.z[j], z));
+				d = _mm_sub_ps(d, frustum.w[j]);
+				culled = _mm_or_ps(culled, _mm_cmplt_ps(d, negRadius));
+			}
+			_visible_[i >> 5] |= (U32)(~_mm_movemask_ps(culled) & 0xf) << (i & 31);
+		}
+	#endif
+
+	for (; i < _count; ++i)
+	{
+		_visible_[i >> 5] |= (U32)isVisible(_origins[i], _radii[i]) << (i & 31);
+	}
+}
+
+void Context::isVisible(const Vec3* _min, const Vec3* _max, U32 _count, U32* _visible_)
+{
+	memset(_visible_, 0, sizeof(U32) * ((_count + 31) / 32));
+	U32 i = 0;
+
+	#if IM3D_SSE
+	 // 4 boxes per iteration, operations match the scalar path so that the results are identical
+		const FrustumSoA frustum(*m_frameConstants);
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= _count; i += 4)
+		{
+			__m128 minX, minY, minZ, maxX, maxY, maxZ;
+			LoadVec3x4(_min + i, minX, minY, minZ);
+			LoadVec3x4(_max + i, maxX, maxY, maxZ);
+			__m128 culled = zero;
+			for (int j = 0; j < frustum.count; ++j)
+			{
+			 // _mm_max_ps(b, a) == Max(a, b), including NaN handling
+				__m128 d = _mm_add_ps(
+					_mm_add_ps(
+						_mm_max_ps(_mm_mul_ps(maxX, frustum.x[j]), _mm_mul_ps(minX, frustum.x[j])),
+						_mm_max_ps(_mm_mul_ps(maxY, frustum.y[j]), _mm_mul_ps(minY, frustum.y[j]))
+						),
+					_mm_max_ps(_mm_mul_ps(maxZ, frustum.z[j]), _mm_mul_ps(minZ, frustum.z[j]))
+					);
+				d = _mm_sub_ps(d, frustum.w[j]);
+				culled = _mm_or_ps(culled, _mm_cmplt_ps(d, zero));
+			}
+			_visible_[i >> 5] |= (U32)(~_mm_movemask_ps(culled) & 0xf) << (i & 31);
+		}
+	#endif
+
+	for (; i < _count; ++i)
+	{
+		_visible_[i >> 5] |= (U32)isVisible(_min[i], _max[i]) << (i & 31);
+	}
+}
+
+// Return true if a primitive is fully transparent, or is a zero-length line or zero-area triangle.
+static bool IsDegenerate(const VertexData* _vdata, DrawPrimitiveType _prim)
+{
+	bool transparent = true;
+	for (int i = 0; i < VertsPerDrawPrimitive[_prim]; ++i)
+	{
+		transparent &= (_vdata[i].m_color.v & 0xff) == 0;
+	}
+	if (transparent)
+	{
+		return true;
+	}
+	const Vec3 p0 = Vec3(_vdata[0].m_positionSize);
+	switch (_prim)
+	{
+		case DrawPrimitive_Lines:
+		{
+			const Vec3 d = Vec3(_vdata[1].m_positionSize) - p0;
+			return d.x * d.x + d.y * d.y + d.z * d.z == 0.0f;
+		}
+		case DrawPrimitive_Triangles:
+		{
+			const Vec3 e1 = Vec3(_vdata[1].m_positionSize) - p0;
+			const Vec3 e2 = Vec3(_vdata[2].m_positionSize) - p0;
+			const Vec3 c  = Vec3(e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x);
+			return c.x * c.x + c.y * c.y + c.z * c.z == 0.0f;
+		}
+		default:
+			return false;
+	};
+}
+
+void Context::compactPrimitives()
+{
+	#if IM3D_SSE
+		const __m128  zero      = _mm_setzero_ps();
+		const __m128i zeroi     = _mm_setzero_si128();
+		const __m128i alphaMask = _mm_set1_epi32(0xff);
+	#endif
+
+	for (int sorted = 0; sorted < 2; ++sorted)
+	{
+		for (U32 list = 0; list < m_vertexData[sorted].size(); ++list)
+		{
+			VertexList& vertexList = *m_vertexData[sorted][list];
+			const DrawPrimitiveType primType = (DrawPrimitiveType)(list % DrawPrimitive_Count);
+			const int vertsPerPrim = VertsPerDrawPrimitive[primType];
+			const U32 primCount = vertexList.size() / vertsPerPrim;
+			const VertexData* src = vertexList.data();
+			m_primitiveKeep.resize((primCount + 31) / 32);
+			memset(m_primitiveKeep.data(), 0, m_primitiveKeep.size() * sizeof(U32));
+			U32 i = 0;
+
+			#if IM3D_SSE
+			 // 4 primitives per iteration, operations match IsDegenerate() so that the results are identical
+				for (; i + 4 <= primCount; i += 4, src += 4 * vertsPerPrim)
+				{
+					__m128 x[3], y[3], z[3];
+					__m128i transparent = _mm_cmpeq_epi32(zeroi, zeroi);
+					for (int k = 0; k < vertsPerPrim; ++k)
+					{
+						__m128 v0 = _mm_loadu_ps(&src[0 * vertsPerPrim + k].m_positionSize.x);
+						__m128 v1 = _mm_loadu_ps(&src[1 * vertsPerPrim + k].m_positionSize.x);
+						__m128 v2 = _mm_loadu_ps(&src[2 * vertsPerPrim + k].m_positionSize.x);
+						__m128 v3 = _mm_loadu_ps(&src[3 * vertsPerPrim + k].m_positionSize.x);
+						_MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+						x[k] = v0;
+						y[k] = v1;
+						z[k] = v2;
+
+						const __m128i color = _mm_set_epi32(
+							(int)src[3 * vertsPerPrim + k].m_color.v,
+							(int)src[2 * vertsPerPrim + k].m_color.v,
+							(int)src[1 * vertsPerPrim + k].m_color.v,
+							(int)src[0 * vertsPerPrim + k].m_color.v
+							);
+						transparent = _mm_and_si128(transparent, _mm_cmpeq_epi32(_mm_and_si128(color, alphaMask), zeroi));
+					}
+
+					__m128 degenerate = _mm_castsi128_ps(transparent);
+					if (primType == DrawPrimitive_Lines)
+					{
+						const __m128 dx = _mm_sub_ps(x[1], x[0]);
+						const __m128 dy = _mm_sub_ps(y[1], y[0]);
+						const __m128 dz = _mm_sub_ps(z[1], z[0]);
+						const __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+						degenerate = _mm_or_ps(degenerate, _mm_cmpeq_ps(len2, zero));
+					}
+					else if (primType == DrawPrimitive_Triangles)
+					{
+						const __m128 e1x = _mm_sub_ps(x[1], x[0]);
+						const __m128 e1y = _mm_sub_ps(y[1], y[0]);
+						const __m128 e1z = _mm_sub_ps(z[1], z[0]);
+						const __m128 e2x = _mm_sub_ps(x[2], x[0]);
+						const __m128 e2y = _mm_sub_ps(y[2], y[0]);
+						const __m128 e2z = _mm_sub_ps(z[2], z[0]);
+						const __m128 cx  = _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y));
+						const __m128 cy  = _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z));
+						const __m128 cz  = _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x));
+						const __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), _mm_mul_ps(cz, cz));
+						degenerate = _mm_or_ps(degenerate, _mm_cmpeq_ps(len2, zero));
+					}
+
+					const U32 keep = ~_mm_movemask_ps(degenerate) & 0xf;
+					m_primitiveKeep[i / 32] |= keep << (i % 32); // i is a multiple of 4, the bits never straddle a word
+				}
+			#endif
+
+			for (; i < primCount; ++i, src += vertsPerPrim)
+			{
+				if (!IsDegenerate(src, primType))
+				{
+					m_primitiveKeep[i / 32] |= 1u << (i % 32);
+				}
+			}
+
+			compactVertexList(vertexList, primType);
+		}
+	}
+}
+
+void Context::cullPrimitives()
+{
+	const FrameConstants& frameConstants = *m_frameConstants;
+	if (frameConstants.m_cullFrustumCount == 0)
+	{
+		return;
+	}
+
+	#if IM3D_SSE
+		const FrustumSoA frustum(frameConstants);
+		const AppData& appData  = *frameConstants.m_appData;
+		const __m128 zero       = _mm_setzero_ps();
+		const __m128 signBit    = _mm_set1_ps(-0.0f);
+		const __m128 viewX      = _mm_set1_ps(appData.m_viewOrigin.x);
+		const __m128 viewY      = _mm_set1_ps(appData.m_viewOrigin.y);
+		const __m128 viewZ      = _mm_set1_ps(appData.m_viewOrigin.z);
+		const __m128 projScaleY = _mm_set1_ps(appData.m_projScaleY);
+		const __m128 viewportY  = _mm_set1_ps(appData.m_viewportSize.y);
+		const __m128 one        = _mm_set1_ps(1.0f);
+	#endif
+
+	for (int sorted = 0; sorted < 2; ++sorted)
+	{
+		for (U32 list = 0; list < m_vertexData[sorted].size(); ++list)
+		{
+			VertexList& vertexList = *m_vertexData[sorted][list];
+			const DrawPrimitiveType primType = (DrawPrimitiveType)(list % DrawPrimitive_Count);
+			const int vertsPerPrim = VertsPerDrawPrimitive[primType];
+			const U32 primCount = vertexList.size() / vertsPerPrim;
+			const VertexData* src = vertexList.data();
+			m_primitiveKeep.resize((primCount + 31) / 32);
+			memset(m_primitiveKeep.data(), 0, m_primitiveKeep.size() * sizeof(U32));
+			U32 i = 0;
+
+			#if IM3D_SSE
+			 // 4 primitives per iteration, operations match isVisible(const VertexData*, DrawPrimitiveType) so that the results are identical
+				for (; i + 4 <= primCount; i += 4, src += 4 * vertsPerPrim)
+				{
+					__m128 x[3], y[3], z[3], negSize[3];
+					for (int k = 0; k < vertsPerPrim; ++k)
+					{
+						__m128 v0 = _mm_loadu_ps(&src[0 * vertsPerPrim + k].m_positionSize.x);
+						__m128 v1 = _mm_loadu_ps(&src[1 * vertsPerPrim + k].m_positionSize.x);
+						__m128 v2 = _mm_loadu_ps(&src[2 * vertsPerPrim + k].m_positionSize.x);
+						__m128 v3 = _mm_loadu_ps(&src[3 * vertsPerPrim + k].m_positionSize.x);
+						_MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+						x[k] = v0;
+						y[k] = v1;
+						z[k] = v2;
+						if (primType == DrawPrimitive_Triangles)
+						{
+							negSize[k] = zero;
+						}
+						else
+						{
+						 // see pixelsToWorldSize()
+							__m128 d = one;
+							if (!appData.m_projOrtho)
+							{
+								const __m128 dx = _mm_sub_ps(v0, viewX);
+								const __m128 dy = _mm_sub_ps(v1, viewY);
+								const __m128 dz = _mm_sub_ps(v2, viewZ);
+								d = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+							}
+							negSize[k] = _mm_xor_ps(_mm_mul_ps(_mm_mul_ps(projScaleY, d), _mm_div_ps(v3, viewportY)), signBit);
+						}
+					}
+
+				 // a primitive is culled if all of its vertices are outside any plane
+					__m128 culled = zero;
+					for (int j = 0; j < frustum.count; ++j)
+					{
+						__m128 outside = _mm_cmpeq_ps(zero, zero);
+						for (int k = 0; k < vertsPerPrim; ++k)
+						{
+							__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(frustum.x[j], x[k]), _mm_mul_ps(frustum.y[j], y[k])), _mm_mul_ps(frustum.z[j], z[k]));
+							d = _mm_sub_ps(d, frustum.w[j]);
+							outside = _mm_and_ps(outside, _mm_cmpngt_ps(d, negSize[k]));
+						}
+						culled = _mm_or_ps(culled, outside);
+					}
+
+					const U32 visible = ~_mm_movemask_ps(culled) & 0xf;
+					m_primitiveKeep[i / 32] |= visible << (i % 32); // i is a multiple of 4, the bits never straddle a word
+				}
+			#endif
+
+			for (; i < primCount; ++i, src += vertsPerPrim)
+			{
+				if (isVisible(src, primType))
+				{
+					m_primitiveKeep[i / 32] |= 1u << (i % 32);
+				}
+			}
+
+			compactVertexList(vertexList, primType);
+		}
+	}
+}
+
+void Context::occludePrimitives()
+{
+	for (U32 layerIndex = 0; layerIndex < m_layerIdMap.size(); ++layerIndex)
+	{
+		if (!m_layerPolicies[layerIndex].m_occlusionCulling)
+		{
+			continue;
+		}
+		for (int sorted = 0; sorted < 2; ++sorted)
+		{
+			for (int primType = 0; primType < DrawPrimitive_Count; ++primType)
+			{
+				VertexList& vertexList = *m_vertexData[sorted][layerIndex * DrawPrimitive_Count + primType];
+				const int vertsPerPrim = VertsPerDrawPrimitive[primType];
+				const U32 primCount = vertexList.size() / vertsPerPrim;
+				const VertexData* src = vertexList.data();
+				m_primitiveKeep.resize((primCount + 31) / 32);
+				memset(m_primitiveKeep.data(), 0, m_primitiveKeep.size() * sizeof(U32));
+				for (U32 i = 0; i < primCount; ++i, src += vertsPerPrim)
+				{
+					if (!isOccluded(src, (DrawPrimitiveType)primType))
+					{
+						m_primitiveKeep[i / 32] |= 1u << (i % 32);
+					}
+				}
+
+				compactVertexList(vertexList, (DrawPrimitiveType)primType);
+			}
+		}
+	}
+}
+
+void Context::compactVertexList(VertexList& _vertexList_, DrawPrimitiveType _primType)
+{
+	const int vertsPerPrim = VertsPerDrawPrimitive[_primType];
+	const U32 primCount = _vertexList_.size() / vertsPerPrim;
+	const VertexData* src = _vertexList_.data();
+	VertexData* dst = _vertexList_.data(); // compact in place, dst never overtakes src
+	for (U32 i = 0; i < primCount; ++i, src += vertsPerPrim)
+	{
+		if (m_primitiveKeep[i / 32] & (1u << (i % 32)))
+		{
+			for (int k = 0; k < vertsPerPrim; ++k)
+			{
+				*dst++ = src[k];
+			}
+		}
+	}
+
+	const U32 vertexCount = (U32)(dst - _vertexList_.data());
+	m_culledPrimitiveCount[_primType] += primCount - vertexCount / vertsPerPrim;
+	_vertexList_.resize(vertexCount);
+}
+
 Context::VertexList* Context::getCurrentVertexList()
 {
 	return m_vertexData[m_vertexDataIndex][m_layerIndex * DrawPrimitive_Count + m_primType];
@@ -2379,39 +4639,79 @@ Context::TextList* Context::getCurrentTextList()
 
 float Context::pixelsToWorldSize(const Vec3& _position, float _pixels)
 {
-	float d = m_appData.m_projOrtho ? 1.0f : Length(_position - m_appData.m_viewOrigin);
-	return m_appData.m_projScaleY * d * (_pixels / m_appData.m_viewportSize.y);
+	float d = getAppData().m_projOrtho ? 1.0f : Length(_position - getAppData().m_viewOrigin);
+	return getAppData().m_projScaleY * d * (_pixels / getAppData().m_viewportSize.y);
 }
 
 float Context::worldSizeToPixels(const Vec3& _position, float _size)
 {
-	float d = m_appData.m_projOrtho ? 1.0f : Length(_position - m_appData.m_viewOrigin);
-	return (_size * m_appData.m_viewportSize.y) / d / m_appData.m_projScaleY;
+	float d = getAppData().m_projOrtho ? 1.0f : Length(_position - getAppData().m_viewOrigin);
+	return (_size * getAppData().m_viewportSize.y) / d / getAppData().m_projScaleY;
 }
 
 int Context::estimateLevelOfDetail(const Vec3& _position, float _worldSize, int _min, int _max)
 {
-	if (m_appData.m_projOrtho)
+	bool projOrtho = getAppData().m_projOrtho;
+	float d2 = Length2(_position - getAppData().m_viewOrigin);
+	if (!m_views.empty())
+	{
+	 // choose LOD for the nearest view
+		d2 = FLT_MAX;
+		for (const View& view : m_views)
+		{
+			const float viewD2 = Length2(_position - view.m_viewOrigin);
+			if (viewD2 < d2)
+			{
+				d2 = viewD2;
+				projOrtho = view.m_projOrtho;
+			}
+		}
+	}
+	if (projOrtho)
 	{
 		return _max;
 	}
 
-	float d = Length(_position - m_appData.m_viewOrigin);
-	float x = Clamp(2.0f * atanf(_worldSize / (2.0f * d)), 0.0f, 1.0f);
+	float d = sqrtf(d2);
+	float x = Clamp(2.0f * atanf(_worldSize / (2.0f * d)) * getLayerPolicy().m_lodBias, 0.0f, 1.0f);
 	float fmin = (float)_min;
 	float fmax = (float)_max;
 
 	return (int)(fmin + (fmax - fmin) * x);
 }
 
+const float* Context::getGizmoRing(int _detail)
+{
+	IM3D_ASSERT(_detail > 0);
+	while ((int)m_gizmoRingOffsets.size() <= _detail)
+	{
+		m_gizmoRingOffsets.push_back(0);
+	}
+	if (m_gizmoRingOffsets[_detail] == 0)
+	{
+		const U32 offset = m_gizmoRingCache.size();
+		const int stride = (_detail + 3) & ~3;
+		for (int i = 0; i < stride; ++i)
+		{
+			m_gizmoRingCache.push_back(cosf(TwoPi * ((float)i / (float)_detail)));
+		}
+		for (int i = 0; i < stride; ++i)
+		{
+			m_gizmoRingCache.push_back(sinf(TwoPi * ((float)i / (float)_detail)));
+		}
+		m_gizmoRingOffsets[_detail] = offset + 1;
+	}
+	return m_gizmoRingCache.data() + m_gizmoRingOffsets[_detail] - 1;
+}
+
 bool Context::gizmoAxisTranslation_Behavior(Id _id, const Vec3& _origin, const Vec3& _axis, float _snap, float _worldHeight, float _worldSize, Vec3* _out_)
 {
 	if (_id != m_hotId)
 	{
 	 // disable behavior when aligned
-		Vec3 viewDir = m_appData.m_projOrtho
-			? m_appData.m_viewDirection
-			: Normalize(m_appData.m_viewOrigin - _origin)
+		Vec3 viewDir = getAppData().m_projOrtho
+			? getAppData().m_viewDirection
+			: Normalize(getAppData().m_viewOrigin - _origin)
 			;
 		float aligned = 1.0f - fabs(Dot(_axis, viewDir));
 		if (aligned < 0.01f)
@@ -2420,19 +4720,19 @@ bool Context::gizmoAxisTranslation_Behavior(Id _id, const Vec3& _origin, const V
 		}
 	}
 
-	Ray ray(m_appData.m_cursorRayOrigin, m_appData.m_cursorRayDirection);
+	Ray ray(getAppData().m_cursorRayOrigin, getAppData().m_cursorRayDirection);
 	Line axisLine(_origin, _axis);
 	Capsule axisCapsule(_origin + _axis * (0.2f * _worldHeight), _origin + _axis * _worldHeight, _worldSize);
 
 	#if IM3D_GIZMO_DEBUG
 		if (_id == m_hotId)
 		{
-			PushDrawState();
-			EnableSorting(false);
-			SetColor(Color_Magenta);
-			SetAlpha(1.0f);
-			DrawCapsule(axisCapsule.m_start, axisCapsule.m_end, axisCapsule.m_radius);
-			PopDrawState();
+			PushDrawState(*this);
+			EnableSorting(*this, false);
+			SetColor(*this, Color_Magenta);
+			SetAlpha(*this, 1.0f);
+			DrawCapsule(*this, axisCapsule.m_start, axisCapsule.m_end, axisCapsule.m_radius);
+			PopDrawState(*this);
 		}
 	#endif
 
@@ -2466,7 +4766,8 @@ bool Context::gizmoAxisTranslation_Behavior(Id _id, const Vec3& _origin, const V
 	}
 	else if (_id == m_hotId)
 	{
-		if (Intersects(ray, axisCapsule))
+		float t0, t1;
+		if (Intersect(ray, axisCapsule, t0, t1))
 		{
 			if (isKeyDown(Action_Select))
 			{
@@ -2475,6 +4776,10 @@ bool Context::gizmoAxisTranslation_Behavior(Id _id, const Vec3& _origin, const V
 				Nearest(ray, axisLine, tr, tl);
 				storedPosition = _axis * tl;
 			}
+			else
+			{
+				makeHot(_id, t0, true); // remain hot in deferred mode
+			}
 		}
 		else
 		{
@@ -2493,9 +4798,9 @@ bool Context::gizmoAxisTranslation_Behavior(Id _id, const Vec3& _origin, const V
 
 void Context::gizmoAxisTranslation_Draw(Id _id, const Vec3& _origin, const Vec3& _axis, float _worldHeight, float _worldSize, Color _color)
 {
-	Vec3 viewDir = m_appData.m_projOrtho
-		? m_appData.m_viewDirection
-		: Normalize(m_appData.m_viewOrigin - _origin)
+	Vec3 viewDir = getAppData().m_projOrtho
+		? getAppData().m_viewDirection
+		: Normalize(getAppData().m_viewOrigin - _origin)
 		;
 	float aligned = 1.0f - fabs(Dot(_axis, viewDir));
 	aligned = Remap(aligned, 0.05f, 0.1f);
@@ -2516,35 +4821,45 @@ void Context::gizmoAxisTranslation_Draw(Id _id, const Vec3& _origin, const Vec3&
 		aligned = 1.0f;
 	}
 	color.setA(color.getA() * aligned);
-	pushColor(color);
-	pushSize(m_gizmoSizePixels);
-		DrawArrow(
-			_origin + _axis * (0.2f * _worldHeight),
-			_origin + _axis * _worldHeight
-			);
-	popSize();
-	popColor();
+
+ // arrow as per DrawArrow(), emitted directly rather than via the color/size stacks
+	const Mat4& world = getMatrix();
+	const Vec3 start = _origin + _axis * (0.2f * _worldHeight);
+	const Vec3 tip = _origin + _axis * _worldHeight;
+	const float headThickness = m_gizmoSizePixels * 2.0f;
+	const float headLength = Min(0.4f * _worldHeight, pixelsToWorldSize(tip, headThickness * 2.0f));
+	const Vec3 head = tip - _axis * headLength;
+	const VertexData arrow[] =
+		{
+			VertexData(world * start, m_gizmoSizePixels, color),
+			VertexData(world * head,  m_gizmoSizePixels, color),
+			VertexData(world * head,  headThickness,     color),
+			VertexData(world * tip,   2.0f,              color), // see DrawArrow()
+		};
+	begin(PrimitiveMode_Lines);
+		vertices(arrow, 4);
+	end();
 }
 
 bool Context::gizmoPlaneTranslation_Behavior(Id _id, const Vec3& _origin, const Vec3& _normal, float _snap, float _worldSize, Vec3* _out_)
 {
-	Ray ray(m_appData.m_cursorRayOrigin, m_appData.m_cursorRayDirection);
+	Ray ray(getAppData().m_cursorRayOrigin, getAppData().m_cursorRayDirection);
 	Plane plane(_normal, _origin);
 
 	#if IM3D_GIZMO_DEBUG
 		if (_id == m_hotId)
 		{
-			PushDrawState();
-			EnableSorting(false);
-			SetColor(Color_Magenta);
-			SetAlpha(0.1f);
-			DrawQuadFilled(_origin, _normal, Vec2(2.0f));
-			SetAlpha(0.75f);
-			SetSize(1.0f);
-			DrawQuad(_origin, _normal, Vec2(2.0f));
-			SetSize(2.0f);
-			DrawCircle(_origin, _normal, 2.0f);
-			PopDrawState();
+			PushDrawState(*this);
+			EnableSorting(*this, false);
+			SetColor(*this, Color_Magenta);
+			SetAlpha(*this, 0.1f);
+			DrawQuadFilled(*this, _origin, _normal, Vec2(2.0f));
+			SetAlpha(*this, 0.75f);
+			SetSize(*this, 1.0f);
+			DrawQuad(*this, _origin, _normal, Vec2(2.0f));
+			SetSize(*this, 2.0f);
+			DrawCircle(*this, _origin, _normal, 2.0f);
+			PopDrawState(*this);
 		}
 	#endif
 
@@ -2585,6 +4900,10 @@ bool Context::gizmoPlaneTranslation_Behavior(Id _id, const Vec3& _origin, const
 				makeActive(_id);
 				storedPosition = *_out_ - intersection;
 			}
+			else
+			{
+				makeHot(_id, tr, true); // remain hot in deferred mode
+			}
 		}
 		else
 		{
@@ -2600,9 +4919,9 @@ bool Context::gizmoPlaneTranslation_Behavior(Id _id, const Vec3& _origin, const
 }
 void Context::gizmoPlaneTranslation_Draw(Id _id, const Vec3& _origin, const Vec3& _normal, float _worldSize, Color _color)
 {
-	Vec3 viewDir = m_appData.m_projOrtho
-		? m_appData.m_viewDirection
-		: Normalize(m_appData.m_viewOrigin - _origin)
+	Vec3 viewDir = getAppData().m_projOrtho
+		? getAppData().m_viewDirection
+		: Normalize(getAppData().m_viewOrigin - _origin)
 		;
 	Vec3 n = Mat3(m_matrixStack.back()) * _normal; // _normal may be in local space, need to transform to world space for the dot with viewDir to make sense
 	float aligned = fabs(Dot(n, viewDir));
@@ -2611,21 +4930,21 @@ void Context::gizmoPlaneTranslation_Draw(Id _id, const Vec3& _origin, const Vec3
 	color.setA(color.getA() * aligned);
 	pushColor(color);
 		pushAlpha(_id == m_hotId ? 0.7f : 0.1f * getAlpha());
-			DrawQuadFilled(_origin, _normal, Vec2(_worldSize));
+			DrawQuadFilled(*this, _origin, _normal, Vec2(_worldSize));
 		popAlpha();
-		DrawQuad(_origin, _normal, Vec2(_worldSize));
+		DrawQuad(*this, _origin, _normal, Vec2(_worldSize));
 	popColor();
 }
 
 bool Context::gizmoAxislAngle_Behavior(Id _id, const Vec3& _origin, const Vec3& _axis, float _snap, float _worldRadius, float _worldSize, float* _out_)
 {
-	Vec3 viewDir = m_appData.m_projOrtho
-		? m_appData.m_viewDirection
-		: Normalize(m_appData.m_viewOrigin - _origin)
+	Vec3 viewDir = getAppData().m_projOrtho
+		? getAppData().m_viewDirection
+		: Normalize(getAppData().m_viewOrigin - _origin)
 		;
 	float aligned = fabs(Dot(_axis, viewDir));
 	float tr = 0.0f;
-	Ray ray(m_appData.m_cursorRayOrigin, m_appData.m_cursorRayDirection);
+	Ray ray(getAppData().m_cursorRayOrigin, getAppData().m_cursorRayDirection);
 	bool intersects = false;
 	Vec3 intersection;
 	if (aligned < 0.05f)
@@ -2639,11 +4958,11 @@ bool Context::gizmoAxislAngle_Behavior(Id _id, const Vec3& _origin, const Vec3&
 		#if IM3D_GIZMO_DEBUG
 			if (_id == m_hotId)
 			{
-				PushDrawState();
-				SetColor(Im3d::Color_Magenta);
-				SetSize(3.0f);
-				DrawCapsule(capsule.m_start, capsule.m_end, capsule.m_radius);
-				PopDrawState();
+				PushDrawState(*this);
+				SetColor(*this, Im3d::Color_Magenta);
+				SetSize(*this, 3.0f);
+				DrawCapsule(*this, capsule.m_start, capsule.m_end, capsule.m_radius);
+				PopDrawState(*this);
 			}
 		#endif
 	}
@@ -2693,7 +5012,11 @@ bool Context::gizmoAxislAngle_Behavior(Id _id, const Vec3& _origin, const Vec3&
 			{
 				makeActive(_id);
 				storedVec = Normalize(intersection - _origin);
-				storedAngle = Snap(*_out_, m_appData.m_snapRotation);
+				storedAngle = Snap(*_out_, getAppData().m_snapRotation);
+			}
+			else
+			{
+				makeHot(_id, tr, true); // remain hot in deferred mode
 			}
 		}
 		else
@@ -2710,9 +5033,9 @@ bool Context::gizmoAxislAngle_Behavior(Id _id, const Vec3& _origin, const Vec3&
 }
 void Context::gizmoAxislAngle_Draw(Id _id, const Vec3& _origin, const Vec3& _axis, float _worldRadius, float _angle, Color _color, float _minAlpha)
 {
-	Vec3 viewDir = m_appData.m_projOrtho
-		? m_appData.m_viewDirection
-		: Normalize(m_appData.m_viewOrigin - _origin)
+	Vec3 viewDir = getAppData().m_projOrtho
+		? getAppData().m_viewDirection
+		: Normalize(getAppData().m_viewOrigin - _origin)
 		;
 	float aligned = fabs(Dot(_axis, viewDir));
 
@@ -2722,7 +5045,7 @@ void Context::gizmoAxislAngle_Draw(Id _id, const Vec3& _origin, const Vec3& _axi
 	if (_id == m_activeId)
 	{
 		color = Color_GizmoHighlight;
-		Ray ray(m_appData.m_cursorRayOrigin, m_appData.m_cursorRayDirection);
+		Ray ray(getAppData().m_cursorRayOrigin, getAppData().m_cursorRayDirection);
 		Plane plane(_axis, _origin);
 		float tr;
 		if (Intersect(ray, plane, tr))
@@ -2743,7 +5066,7 @@ void Context::gizmoAxislAngle_Draw(Id _id, const Vec3& _origin, const Vec3& _axi
 
 			pushColor(Color_GizmoHighlight);
 			pushSize(m_gizmoSizePixels);
-				DrawArrow(_origin, _origin + delta * _worldRadius);
+				DrawArrow(*this, _origin, _origin + delta * _worldRadius);
 			popSize();
 			popColor();
 			begin(PrimitiveMode_Points);
@@ -2761,44 +5084,99 @@ void Context::gizmoAxislAngle_Draw(Id _id, const Vec3& _origin, const Vec3& _axi
 	{
 		aligned = 1.0f;
 	}
-	pushColor(color);
-	pushSize(m_gizmoSizePixels);
-	pushMatrix(getMatrix() * LookAt(_origin, _origin + _axis, m_appData.m_worldUp));
-	begin(PrimitiveMode_LineLoop);
-		const int detail = estimateLevelOfDetail(_origin, _worldRadius, 32, 128);
-		for (int i = 0; i < detail; ++i)
-		{
-			float rad = TwoPi * ((float)i / (float)detail);
-			vertex(Vec3(cosf(rad) * _worldRadius, sinf(rad) * _worldRadius, 0.0f));
-
-		 // post-modify the alpha for parts of the ring occluded by the sphere
-			VertexData& vd = getCurrentVertexList()->back();
-			Vec3 v = vd.m_positionSize;
-			float d = Dot(Normalize(_origin - v), m_appData.m_viewDirection);
+
+ // the ring is a cached unit circle transformed into the plane of _axis (as per pushMatrix(LookAt(_origin, _origin + _axis, m_worldUp)))
+	const int detail = estimateLevelOfDetail(_origin, _worldRadius, 32, 128);
+	const float* ringCos = getGizmoRing(detail);
+	const float* ringSin = ringCos + ((detail + 3) & ~3);
+	const Mat4 world = getMatrix() * LookAt(_origin, _origin + _axis, getAppData().m_worldUp);
+	const Vec3 center = world * Vec3(0.0f);
+	const Vec3 basisX = Vec3(world * Vec4(_worldRadius, 0.0f, 0.0f, 0.0f));
+	const Vec3 basisY = Vec3(world * Vec4(0.0f, _worldRadius, 0.0f, 0.0f));
+	const Vec3 viewDirection = getAppData().m_viewDirection;
+	const float colorAlpha = color.getA();
+
+ // each ring vertex is the start of one line and the end of the previous one, as per PrimitiveMode_LineLoop
+	m_gizmoVertices.resize(detail * 2);
+	VertexData* ring = m_gizmoVertices.data();
+	int i = 0;
+	#if IM3D_SSE
+	 // 4 vertices at a time, the cached rings are padded to a multiple of 4
+		const __m128 remapScale = _mm_set1_ps(1.0f / (0.2f - 0.1f));
+		const __m128 remapBias  = _mm_set1_ps(-0.1f / (0.2f - 0.1f));
+		const __m128 minAlpha   = _mm_set1_ps(Max(_minAlpha, aligned));
+		for (; i < detail; i += 4)
+		{
+			const __m128 c = _mm_loadu_ps(ringCos + i);
+			const __m128 s = _mm_loadu_ps(ringSin + i);
+			__m128 p[3];
+			__m128 d = _mm_setzero_ps();
+			__m128 len = _mm_setzero_ps();
+			for (int j = 0; j < 3; ++j)
+			{
+				p[j] = _mm_add_ps(_mm_set1_ps(center[j]), _mm_add_ps(_mm_mul_ps(c, _mm_set1_ps(basisX[j])), _mm_mul_ps(s, _mm_set1_ps(basisY[j]))));
+				const __m128 delta = _mm_sub_ps(_mm_set1_ps(_origin[j]), p[j]);
+				d   = _mm_add_ps(d, _mm_mul_ps(delta, _mm_set1_ps(viewDirection[j])));
+				len = _mm_add_ps(len, _mm_mul_ps(delta, delta));
+			}
+		 // fade parts of the ring occluded by the sphere
+			d = _mm_div_ps(d, _mm_sqrt_ps(len));
+			d = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(d, remapScale), remapBias), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+			d = _mm_max_ps(d, minAlpha);
+
+			alignas(16) float px[4], py[4], pz[4], alpha[4];
+			_mm_store_ps(px, p[0]);
+			_mm_store_ps(py, p[1]);
+			_mm_store_ps(pz, p[2]);
+			_mm_store_ps(alpha, d);
+			for (int j = 0, n = Min(4, detail - i); j < n; ++j)
+			{
+				VertexData& vd = ring[(i + j) * 2];
+				vd.m_positionSize = Vec4(px[j], py[j], pz[j], m_gizmoSizePixels);
+				vd.m_color = color;
+				vd.m_color.setA(colorAlpha * alpha[j]);
+			}
+		}
+	#else
+		for (; i < detail; ++i)
+		{
+			const Vec3 v = center + basisX * ringCos[i] + basisY * ringSin[i];
+
+		 // fade parts of the ring occluded by the sphere
+			float d = Dot(Normalize(_origin - v), viewDirection);
 			d = Max(_minAlpha, Max(Remap(d, 0.1f, 0.2f), aligned));
-			vd.m_color.setA(vd.m_color.getA() * d);
+
+			VertexData& vd = ring[i * 2];
+			vd.m_positionSize = Vec4(v, m_gizmoSizePixels);
+			vd.m_color = color;
+			vd.m_color.setA(colorAlpha * d);
 		}
+	#endif
+	for (i = 0; i < detail; ++i)
+	{
+		ring[i * 2 + 1] = ring[((i + 1) % detail) * 2];
+	}
+
+	begin(PrimitiveMode_Lines);
+		vertices(ring, detail * 2);
 	end();
-	popMatrix();
-	popSize();
-	popColor();
 }
 
 bool Context::gizmoAxisScale_Behavior(Id _id, const Vec3& _origin, const Vec3& _axis, float _snap, float _worldHeight, float _worldSize, float *_out_)
 {
-	Ray ray(m_appData.m_cursorRayOrigin, m_appData.m_cursorRayDirection);
+	Ray ray(getAppData().m_cursorRayOrigin, getAppData().m_cursorRayDirection);
 	Line axisLine(_origin, _axis);
 	Capsule axisCapsule(_origin + _axis * (0.2f * _worldHeight), _origin + _axis * _worldHeight, _worldSize);
 
 	#if IM3D_GIZMO_DEBUG
 		if (_id == m_hotId)
 		{
-			PushDrawState();
-			EnableSorting(false);
-			SetColor(Color_Magenta);
-			SetAlpha(1.0f);
-			DrawCapsule(axisCapsule.m_start, axisCapsule.m_end, axisCapsule.m_radius);
-			PopDrawState();
+			PushDrawState(*this);
+			EnableSorting(*this, false);
+			SetColor(*this, Color_Magenta);
+			SetAlpha(*this, 1.0f);
+			DrawCapsule(*this, axisCapsule.m_start, axisCapsule.m_end, axisCapsule.m_radius);
+			PopDrawState(*this);
 		}
 	#endif
 
@@ -2834,7 +5212,8 @@ bool Context::gizmoAxisScale_Behavior(Id _id, const Vec3& _origin, const Vec3& _
 	}
 	else if (_id == m_hotId)
 	{
-		if (Intersects(ray, axisCapsule))
+		float t0, t1;
+		if (Intersect(ray, axisCapsule, t0, t1))
 		{
 			if (isKeyDown(Action_Select))
 			{
@@ -2844,6 +5223,10 @@ bool Context::gizmoAxisScale_Behavior(Id _id, const Vec3& _origin, const Vec3& _
 				storedPosition = _axis * tl;
 				storedScale = *_out_;
 			}
+			else
+			{
+				makeHot(_id, t0, true); // remain hot in deferred mode
+			}
 		}
 		else
 		{
@@ -2861,9 +5244,9 @@ bool Context::gizmoAxisScale_Behavior(Id _id, const Vec3& _origin, const Vec3& _
 }
 void Context::gizmoAxisScale_Draw(Id _id, const Vec3& _origin, const Vec3& _axis, float _worldHeight, float _worldSize, Color _color)
 {
-	Vec3 viewDir = m_appData.m_projOrtho
-		? m_appData.m_viewDirection
-		: Normalize(m_appData.m_viewOrigin - _origin)
+	Vec3 viewDir = getAppData().m_projOrtho
+		? getAppData().m_viewDirection
+		: Normalize(getAppData().m_viewOrigin - _origin)
 		;
 	float aligned = 1.0f - fabs(Dot(_axis, viewDir));
 	aligned = Remap(aligned, 0.05f, 0.1f);
@@ -2884,18 +5267,40 @@ void Context::gizmoAxisScale_Draw(Id _id, const Vec3& _origin, const Vec3& _axis
 		aligned = 1.0f;
 	}
 	color.setA(color.getA() * aligned);
-	begin(PrimitiveMode_LineLoop);
-		vertex(_origin + _axis * (0.2f * _worldHeight), m_gizmoSizePixels, color);
-		vertex(_origin + _axis * _worldHeight, m_gizmoSizePixels, color);
+
+ // a single line (a 2 vertex line loop would draw it twice) plus the end point
+	const Mat4& world = getMatrix();
+	const Vec3 tip = world * (_origin + _axis * _worldHeight);
+	const VertexData line[] =
+		{
+			VertexData(world * (_origin + _axis * (0.2f * _worldHeight)), m_gizmoSizePixels, color),
+			VertexData(tip, m_gizmoSizePixels, color),
+		};
+	const VertexData point(tip, m_gizmoSizePixels * 2.0f, color);
+	begin(PrimitiveMode_Lines);
+		vertices(line, 2);
 	end();
 	begin(PrimitiveMode_Points);
-		vertex(_origin + _axis * _worldHeight, m_gizmoSizePixels * 2.0f, color);
+		vertices(&point, 1);
 	end();
 }
 
 bool Context::makeHot(Id _id, float _depth, bool _intersects)
 {
-	if (m_activeId == Id_Invalid &&	_depth < m_hotDepth && _intersects && !isKeyDown(Action_Select))
+	if (m_deferHot)
+	{
+	 // m_hotId stays fixed until endFrame() so that every gizmo sees the same hot ID this frame, regardless of call order
+		if (m_activeId == Id_Invalid && _depth < m_hotCandidateDepth && _intersects && !isKeyDown(Action_Select))
+		{
+			m_hotCandidateId = _id;
+			m_appHotCandidateId = m_appId;
+			m_hotCandidateDepth = _depth;
+			submitHotCandidate();
+		}
+		return false;
+	}
+
+	if (m_activeId == Id_Invalid && _id != m_hotId && _depth < m_hotDepth && _intersects && !isKeyDown(Action_Select))
 	{
 		m_hotId = _id;
 		m_appHotId = m_appId;
@@ -2909,6 +5314,14 @@ bool Context::makeHot(Id _id, float _depth, bool _intersects)
 
 void Context::makeActive(Id _id)
 {
+	if (m_deferHot && _id == Id_Invalid && m_activeId != Id_Invalid && m_hotDepth < m_hotCandidateDepth)
+	{
+	 // the released gizmo remains hot, as per the immediate mode where m_hotId is unchanged
+		m_hotCandidateId = m_activeId;
+		m_appHotCandidateId = m_appActiveId;
+		m_hotCandidateDepth = m_hotDepth;
+		submitHotCandidate();
+	}
 	m_activeId = _id;
 	m_appActiveId = _id == Id_Invalid ? Id_Invalid : m_appId;
 	m_appIdActivated = m_appActiveId;
@@ -2920,6 +5333,171 @@ void Context::resetId()
 	m_hotDepth = FLT_MAX;
 }
 
+// Slab test, operations match the SSE path in Context::pickBoxes().
+static bool IntersectBox(const Vec3& _rayOrigin, const Vec3& _rayInvDirection, const Vec3& _min, const Vec3& _max, float& t0_)
+{
+	const float tx0 = (_min.x - _rayOrigin.x) * _rayInvDirection.x;
+	const float tx1 = (_max.x - _rayOrigin.x) * _rayInvDirection.x;
+	const float ty0 = (_min.y - _rayOrigin.y) * _rayInvDirection.y;
+	const float ty1 = (_max.y - _rayOrigin.y) * _rayInvDirection.y;
+	const float tz0 = (_min.z - _rayOrigin.z) * _rayInvDirection.z;
+	const float tz1 = (_max.z - _rayOrigin.z) * _rayInvDirection.z;
+	const float tmin = Max(Max(Min(tx0, tx1), Min(ty0, ty1)), Min(tz0, tz1));
+	const float tmax = Min(Min(Max(tx0, tx1), Max(ty0, ty1)), Max(tz0, tz1));
+	t0_ = Max(tmin, 0.0f);
+	return tmax >= t0_;
+}
+
+void Context::pickSphere(Id _id, const Vec3& _origin, float _radius)
+{
+	const Ray ray(getAppData().m_cursorRayOrigin, getAppData().m_cursorRayDirection);
+	float t0, t1;
+	if (Intersect(ray, Sphere(_origin, _radius), t0, t1) && t0 < m_pickDepth)
+	{
+		m_pickId = _id;
+		m_pickDepth = t0;
+	}
+}
+
+void Context::pickBox(Id _id, const Vec3& _min, const Vec3& _max)
+{
+	const Vec3& rayDirection = getAppData().m_cursorRayDirection;
+	const Vec3 rayInvDirection = Vec3(1.0f / rayDirection.x, 1.0f / rayDirection.y, 1.0f / rayDirection.z);
+	float t0;
+	if (IntersectBox(getAppData().m_cursorRayOrigin, rayInvDirection, _min, _max, t0) && t0 < m_pickDepth)
+	{
+		m_pickId = _id;
+		m_pickDepth = t0;
+	}
+}
+
+void Context::pickCapsule(Id _id, const Vec3& _start, const Vec3& _end, float _radius)
+{
+ // Intersect(Ray, Capsule) doesn't return t, the depth is the entry point of the sphere around the segment point nearest to the ray
+	const Ray ray(getAppData().m_cursorRayOrigin, getAppData().m_cursorRayDirection);
+	float tr;
+	const Vec3 nearest = Nearest(ray, LineSegment(_start, _end), tr);
+	const float d2 = Length2(ray.m_origin + ray.m_direction * tr - nearest);
+	const float r2 = _radius * _radius;
+	if (d2 < r2)
+	{
+		const float t0 = Max(tr - sqrtf(r2 - d2), 0.0f);
+		if (t0 < m_pickDepth)
+		{
+			m_pickId = _id;
+			m_pickDepth = t0;
+		}
+	}
+}
+
+void Context::pickSpheres(const Id* _ids, const Vec3* _origins, const float* _radii, U32 _count)
+{
+	U32 i = 0;
+
+	#if IM3D_SSE
+	 // 4 spheres per iteration, operations match Intersect(const Ray&, const Sphere&, float&, float&) so that the results are identical
+		const Vec3& rayOrigin    = getAppData().m_cursorRayOrigin;
+		const Vec3& rayDirection = getAppData().m_cursorRayDirection;
+		const __m128 ox    = _mm_set1_ps(rayOrigin.x);
+		const __m128 oy    = _mm_set1_ps(rayOrigin.y);
+		const __m128 oz    = _mm_set1_ps(rayOrigin.z);
+		const __m128 dx    = _mm_set1_ps(rayDirection.x);
+		const __m128 dy    = _mm_set1_ps(rayDirection.y);
+		const __m128 dz    = _mm_set1_ps(rayDirection.z);
+		const __m128 zero  = _mm_setzero_ps();
+		const __m128 noHit = _mm_set1_ps(FLT_MAX);
+		for (; i + 4 <= _count; i += 4)
+		{
+			__m128 x, y, z;
+			LoadVec3x4(_origins + i, x, y, z);
+			const __m128 px   = _mm_sub_ps(x, ox);
+			const __m128 py   = _mm_sub_ps(y, oy);
+			const __m128 pz   = _mm_sub_ps(z, oz);
+			const __m128 q    = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, dx), _mm_mul_ps(py, dy)), _mm_mul_ps(pz, dz));
+			const __m128 p2   = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_mul_ps(pz, pz)), _mm_mul_ps(q, q));
+			const __m128 r    = _mm_loadu_ps(_radii + i);
+			const __m128 r2   = _mm_mul_ps(r, r);
+			const __m128 miss = _mm_or_ps(_mm_cmplt_ps(q, zero), _mm_cmpgt_ps(p2, r2));
+			const __m128 t0   = _mm_max_ps(zero, _mm_sub_ps(q, _mm_sqrt_ps(_mm_sub_ps(r2, p2)))); // _mm_max_ps(b, a) == Max(a, b)
+			const __m128 t    = _mm_or_ps(_mm_and_ps(miss, noHit), _mm_andnot_ps(miss, t0));
+			if (_mm_movemask_ps(_mm_cmplt_ps(t, _mm_set1_ps(m_pickDepth))) != 0)
+			{
+			 // in order, ties resolve as in the scalar path
+				alignas(16) float depth[4];
+				_mm_store_ps(depth, t);
+				for (U32 j = 0; j < 4; ++j)
+				{
+					if (depth[j] < m_pickDepth)
+					{
+						m_pickId = _ids[i + j];
+						m_pickDepth = depth[j];
+					}
+				}
+			}
+		}
+	#endif
+
+	for (; i < _count; ++i)
+	{
+		pickSphere(_ids[i], _origins[i], _radii[i]);
+	}
+}
+
+void Context::pickBoxes(const Id* _ids, const Vec3* _min, const Vec3* _max, U32 _count)
+{
+	U32 i = 0;
+
+	#if IM3D_SSE
+	 // 4 boxes per iteration, operations match IntersectBox() so that the results are identical
+		const Vec3& rayOrigin    = getAppData().m_cursorRayOrigin;
+		const Vec3& rayDirection = getAppData().m_cursorRayDirection;
+		const __m128 ox    = _mm_set1_ps(rayOrigin.x);
+		const __m128 oy    = _mm_set1_ps(rayOrigin.y);
+		const __m128 oz    = _mm_set1_ps(rayOrigin.z);
+		const __m128 ix    = _mm_set1_ps(1.0f / rayDirection.x);
+		const __m128 iy    = _mm_set1_ps(1.0f / rayDirection.y);
+		const __m128 iz    = _mm_set1_ps(1.0f / rayDirection.z);
+		const __m128 zero  = _mm_setzero_ps();
+		const __m128 noHit = _mm_set1_ps(FLT_MAX);
+		for (; i + 4 <= _count; i += 4)
+		{
+			__m128 minX, minY, minZ, maxX, maxY, maxZ;
+			LoadVec3x4(_min + i, minX, minY, minZ);
+			LoadVec3x4(_max + i, maxX, maxY, maxZ);
+			const __m128 tx0 = _mm_mul_ps(_mm_sub_ps(minX, ox), ix);
+			const __m128 tx1 = _mm_mul_ps(_mm_sub_ps(maxX, ox), ix);
+			const __m128 ty0 = _mm_mul_ps(_mm_sub_ps(minY, oy), iy);
+			const __m128 ty1 = _mm_mul_ps(_mm_sub_ps(maxY, oy), iy);
+			const __m128 tz0 = _mm_mul_ps(_mm_sub_ps(minZ, oz), iz);
+			const __m128 tz1 = _mm_mul_ps(_mm_sub_ps(maxZ, oz), iz);
+		 // _mm_min_ps(a, b) == Min(a, b), _mm_max_ps(b, a) == Max(a, b)
+			const __m128 tmin = _mm_max_ps(_mm_min_ps(tz0, tz1), _mm_max_ps(_mm_min_ps(ty0, ty1), _mm_min_ps(tx0, tx1)));
+			const __m128 tmax = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx1, tx0), _mm_max_ps(ty1, ty0)), _mm_max_ps(tz1, tz0));
+			const __m128 t0   = _mm_max_ps(zero, tmin);
+			const __m128 hit  = _mm_cmpge_ps(tmax, t0);
+			const __m128 t    = _mm_or_ps(_mm_and_ps(hit, t0), _mm_andnot_ps(hit, noHit));
+			if (_mm_movemask_ps(_mm_cmplt_ps(t, _mm_set1_ps(m_pickDepth))) != 0)
+			{
+				alignas(16) float depth[4];
+				_mm_store_ps(depth, t);
+				for (U32 j = 0; j < 4; ++j)
+				{
+					if (depth[j] < m_pickDepth)
+					{
+						m_pickId = _ids[i + j];
+						m_pickDepth = depth[j];
+					}
+				}
+			}
+		}
+	#endif
+
+	for (; i < _count; ++i)
+	{
+		pickBox(_ids[i], _min[i], _max[i]);
+	}
+}
+
 U32 Context::getPrimitiveCount(DrawPrimitiveType _type) const
 {
 	U32 ret = 0;
@@ -2933,6 +5511,18 @@ U32 Context::getPrimitiveCount(DrawPrimitiveType _type) const
 	return ret;
 }
 
+U32 Context::getCulledPrimitiveCount(DrawPrimitiveType _type) const
+{
+	return m_culledPrimitiveCount[_type];
+}
+
+float Context::getCullRate(DrawPrimitiveType _type) const
+{
+	const U32 culled = getCulledPrimitiveCount(_type);
+	const U32 total  = culled + getPrimitiveCount(_type);
+	return total > 0 ? (float)culled / (float)total : 0.0f;
+}
+
 U32 Context::getTextCount() const
 {
 	U32 ret = 0;
@@ -2944,6 +5534,315 @@ U32 Context::getTextCount() const
 	return ret;
 }
 
+/*******************************************************************************
+
+                                 Recorder
+
+*******************************************************************************/
+
+Recorder::Recorder(Context& _parent)
+{
+	m_parent = &_parent;
+	#if IM3D_THREAD_SAFE_SUBMISSION
+		const Context& ctx = _parent.getThreadContext();
+	#else
+		const Context& ctx = _parent;
+	#endif
+	m_color         = ctx.getColor();
+	m_alpha         = ctx.getAlpha();
+	m_size          = ctx.getSize();
+	m_enableSorting = ctx.getEnableSorting();
+	m_layerId       = ctx.getLayerId();
+	m_layerPolicy   = ctx.getLayerPolicy();
+	m_culled        = ctx.isCullScopeCulled();
+	m_useMatrix     = ctx.m_matrixStack.size() > 1;
+	if (m_useMatrix)
+	{
+		m_matrix = ctx.getMatrix();
+	}
+	else
+	{
+		m_matrix = Mat4(1.0f);
+	}
+
+	m_primMode          = PrimitiveMode_None;
+	m_primType          = DrawPrimitive_Count;
+	m_firstVertThisPrim = 0;
+	m_vertCountThisPrim = 0;
+	m_discardThisPrim   = false;
+	memset(m_culledPrimitiveCount, 0, sizeof(m_culledPrimitiveCount));
+
+	m_vertexData        = (VertexData*)m_inlineVertexData;
+	m_vertexCount       = 0;
+	m_vertexCapacity    = IM3D_RECORDER_INLINE_VERTEX_COUNT;
+	m_batches           = m_inlineBatches;
+	m_batchCount        = 0;
+	m_batchCapacity     = InlineBatchCount;
+}
+
+void Recorder::setLayerId(Id _layer)
+{
+	IM3D_ASSERT(m_primMode == PrimitiveMode_None); // can't change layer mid-primitive
+	m_layerId = _layer;
+	#if IM3D_THREAD_SAFE_SUBMISSION
+		m_layerPolicy = m_parent->getThreadContext().getLayerPolicy(_layer);
+	#else
+		m_layerPolicy = m_parent->getLayerPolicy(_layer);
+	#endif
+}
+
+Recorder::~Recorder()
+{
+	submit();
+	if (m_vertexData != (VertexData*)m_inlineVertexData)
+	{
+		AlignedFree(m_vertexData);
+	}
+	if (m_batches != m_inlineBatches)
+	{
+		AlignedFree(m_batches);
+	}
+}
+
+void Recorder::begin(PrimitiveMode _mode)
+{
+	IM3D_ASSERT(m_primMode == PrimitiveMode_None); // forgot to call end()
+	m_primMode = _mode;
+	m_vertCountThisPrim = 0;
+	switch (m_primMode)
+	{
+		case PrimitiveMode_Points:
+			m_primType = DrawPrimitive_Points;
+			break;
+		case PrimitiveMode_Lines:
+		case PrimitiveMode_LineStrip:
+		case PrimitiveMode_LineLoop:
+			m_primType = DrawPrimitive_Lines;
+			break;
+		case PrimitiveMode_Triangles:
+		case PrimitiveMode_TriangleStrip:
+			m_primType = DrawPrimitive_Triangles;
+			break;
+		default:
+			break;
+	};
+	m_firstVertThisPrim = m_vertexCount;
+	m_discardThisPrim = m_culled || m_alpha == 0.0f;
+}
+
+void Recorder::end()
+{
+	IM3D_ASSERT(m_primMode != PrimitiveMode_None); // end() called without begin()
+	if (m_vertCountThisPrim > 0)
+	{
+		switch (m_primMode)
+		{
+			case PrimitiveMode_Lines:
+				IM3D_ASSERT(m_vertCountThisPrim % 2 == 0);
+				break;
+			case PrimitiveMode_LineStrip:
+				IM3D_ASSERT(m_vertCountThisPrim > 1);
+				break;
+			case PrimitiveMode_LineLoop:
+				IM3D_ASSERT(m_vertCountThisPrim > 1);
+				pushVertex(m_vertexData[m_vertexCount - 1]);
+				pushVertex(m_vertexData[m_firstVertThisPrim]);
+				break;
+			case PrimitiveMode_Triangles:
+				IM3D_ASSERT(m_vertCountThisPrim % 3 == 0);
+				break;
+			case PrimitiveMode_TriangleStrip:
+				IM3D_ASSERT(m_vertCountThisPrim >= 3);
+				break;
+			default:
+				break;
+		};
+		#if IM3D_CULL_PRIMITIVES
+			if (!m_parent->isVisible(m_minVertThisPrim, m_maxVertThisPrim))
+			{
+				m_culledPrimitiveCount[m_primType] += (m_vertexCount - m_firstVertThisPrim) / VertsPerDrawPrimitive[m_primType];
+				m_vertexCount = m_firstVertThisPrim;
+			}
+		#endif
+
+		if (m_parent->getAppData().m_minPixelSize > 0.0f && m_primMode != PrimitiveMode_Points && m_vertexCount > m_firstVertThisPrim)
+		{
+			if (BelowMinPixelSize(*m_parent, m_vertexData + m_firstVertThisPrim, m_vertexCount - m_firstVertThisPrim))
+			{
+				m_culledPrimitiveCount[m_primType] += (m_vertexCount - m_firstVertThisPrim) / VertsPerDrawPrimitive[m_primType];
+				m_vertexCount = m_firstVertThisPrim;
+			}
+		}
+
+		if (m_layerPolicy.m_maxDistance > 0.0f && m_vertexCount > m_firstVertThisPrim)
+		{
+			if (BeyondMaxDistance(m_layerPolicy, m_parent->getAppData().m_viewOrigin, m_vertexData + m_firstVertThisPrim, m_vertexCount - m_firstVertThisPrim))
+			{
+				m_culledPrimitiveCount[m_primType] += (m_vertexCount - m_firstVertThisPrim) / VertsPerDrawPrimitive[m_primType];
+				m_vertexCount = m_firstVertThisPrim;
+			}
+		}
+	}
+
+	const U32 vertexCount = m_vertexCount - m_firstVertThisPrim;
+	if (vertexCount > 0)
+	{
+	 // extend the previous batch if possible, else start a new one
+		Batch* batch = m_batchCount > 0 ? &m_batches[m_batchCount - 1] : nullptr;
+		if (!batch || batch->m_layerId != m_layerId || batch->m_primType != m_primType || batch->m_sorted != m_enableSorting)
+		{
+			if (m_batchCount == m_batchCapacity)
+			{
+				const U32 capacity = m_batchCapacity * 2;
+				Batch* batches = (Batch*)AlignedMalloc(sizeof(Batch) * capacity, alignof(Batch));
+				memcpy(batches, m_batches, sizeof(Batch) * m_batchCount);
+				if (m_batches != m_inlineBatches)
+				{
+					AlignedFree(m_batches);
+				}
+				m_batches = batches;
+				m_batchCapacity = capacity;
+			}
+			batch = &m_batches[m_batchCount++];
+			batch->m_layerId     = m_layerId;
+			batch->m_primType    = m_primType;
+			batch->m_sorted      = m_enableSorting;
+			batch->m_vertexCount = 0;
+		}
+		batch->m_vertexCount += vertexCount;
+	}
+
+	m_primMode = PrimitiveMode_None;
+	m_primType = DrawPrimitive_Count;
+}
+
+void Recorder::vertex(const Vec3& _position, float _size, Color _color)
+{
+	IM3D_ASSERT(m_primMode != PrimitiveMode_None); // vertex() called without begin()
+	if_unlikely (m_discardThisPrim)
+	{
+		return;
+	}
+
+	VertexData vd(_position, _size, _color);
+	if (m_useMatrix)
+	{
+		vd.m_positionSize = Vec4(m_matrix * _position, _size);
+	}
+	vd.m_color.setA(vd.m_color.getA() * m_alpha);
+	if_unlikely (m_layerPolicy.m_fadeDistance > 0.0f && m_layerPolicy.m_maxDistance > 0.0f)
+	{
+		vd.m_color.setA(vd.m_color.getA() * DistanceFade(m_layerPolicy, m_parent->getAppData().m_viewOrigin, Vec3(vd.m_positionSize)));
+	}
+
+	#if IM3D_CULL_PRIMITIVES
+	 // inflate the bounds by the vertex size (as per isVisible(const VertexData*, DrawPrimitiveType))
+		const Vec3 p = Vec3(vd.m_positionSize);
+		const Vec3 r = Vec3(m_primType == DrawPrimitive_Triangles ? 0.0f : m_parent->pixelsToWorldSize(p, _size));
+		if (m_vertCountThisPrim == 0) // p is the first vertex
+		{
+			m_minVertThisPrim = p - r;
+			m_maxVertThisPrim = p + r;
+		}
+		else
+		{
+			m_minVertThisPrim = Min(m_minVertThisPrim, p - r);
+			m_maxVertThisPrim = Max(m_maxVertThisPrim, p + r);
+		}
+	#endif
+
+	switch (m_primMode)
+	{
+		case PrimitiveMode_Points:
+		case PrimitiveMode_Lines:
+		case PrimitiveMode_Triangles:
+			pushVertex(vd);
+			break;
+		case PrimitiveMode_LineStrip:
+		case PrimitiveMode_LineLoop:
+			if (m_vertCountThisPrim >= 2)
+			{
+				pushVertex(m_vertexData[m_vertexCount - 1]);
+				++m_vertCountThisPrim;
+			}
+			pushVertex(vd);
+			break;
+		case PrimitiveMode_TriangleStrip:
+			if (m_vertCountThisPrim >= 3)
+			{
+				pushVertex(m_vertexData[m_vertexCount - 2]);
+				pushVertex(m_vertexData[m_vertexCount - 2]);
+				m_vertCountThisPrim += 2;
+			}
+			pushVertex(vd);
+			break;
+		default:
+			break;
+	};
+	++m_vertCountThisPrim;
+}
+
+void Recorder::submit()
+{
+	IM3D_ASSERT(m_primMode == PrimitiveMode_None); // forgot to call end()
+	U32 culledCount = 0;
+	for (int i = 0; i < DrawPrimitive_Count; ++i)
+	{
+		culledCount += m_culledPrimitiveCount[i];
+	}
+	if (m_batchCount == 0 && culledCount == 0)
+	{
+		return;
+	}
+
+	#if IM3D_THREAD_SAFE_SUBMISSION
+		Context& ctx = m_parent->getThreadContext();
+	#else
+		Context& ctx = *m_parent;
+	#endif
+	IM3D_ASSERT(!ctx.m_endFrameCalled); // submit() called after EndFrame() but before NewFrame()
+
+	for (int i = 0; i < DrawPrimitive_Count; ++i)
+	{
+		ctx.m_culledPrimitiveCount[i] += m_culledPrimitiveCount[i];
+		m_culledPrimitiveCount[i] = 0;
+	}
+
+	const VertexData* vertexData = m_vertexData;
+	for (U32 i = 0; i < m_batchCount; ++i)
+	{
+		const Batch& batch = m_batches[i];
+		ctx.pushLayerId(batch.m_layerId); // creates the layer if required
+		ctx.m_vertexData[batch.m_sorted ? 1 : 0][ctx.m_layerIndex * DrawPrimitive_Count + batch.m_primType]->append(vertexData, batch.m_vertexCount);
+		if (!batch.m_sorted)
+		{
+			ctx.flushVertexList(ctx.m_layerIndex, batch.m_primType);
+		}
+		ctx.popLayerId();
+		vertexData += batch.m_vertexCount;
+	}
+
+	m_vertexCount = 0;
+	m_batchCount = 0;
+}
+
+void Recorder::pushVertex(VertexData _vd) // by value, _vd may reference m_vertexData
+{
+	if_unlikely (m_vertexCount == m_vertexCapacity)
+	{
+		const U32 capacity = m_vertexCapacity * 2;
+		VertexData* vertexData = (VertexData*)AlignedMalloc(sizeof(VertexData) * capacity, alignof(VertexData));
+		memcpy(vertexData, m_vertexData, sizeof(VertexData) * m_vertexCount);
+		if (m_vertexData != (VertexData*)m_inlineVertexData)
+		{
+			AlignedFree(m_vertexData);
+		}
+		m_vertexData = vertexData;
+		m_vertexCapacity = capacity;
+	}
+	m_vertexData[m_vertexCount++] = _vd;
+}
+
 /******************************************************************************
 
                                  im3d_math
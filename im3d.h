@@ -7,7 +7,7 @@
 	#include "im3d_config.h"
 #endif
 
-#define IM3D_VERSION "1.18"
+#define IM3D_VERSION "1.19"
 
 #ifndef IM3D_API
 	#define IM3D_API
@@ -22,11 +22,16 @@
 	#define IM3D_VERTEX_ALIGNMENT 4
 #endif
 
+#ifndef IM3D_RECORDER_INLINE_VERTEX_COUNT
+	#define IM3D_RECORDER_INLINE_VERTEX_COUNT 64
+#endif
+
 #include <cstdarg> // va_list
 
 namespace Im3d {
 
 typedef unsigned int U32;
+typedef unsigned long long U64;
 struct Vec2;
 struct Vec3;
 struct Vec4;
@@ -35,13 +40,33 @@ struct Mat4;
 struct Color;
 struct VertexData;
 struct AppData;
+struct OcclusionBuffer;
 struct DrawList;
 struct TextDrawList;
+struct TextQuadList;
+struct Font;
 struct Context;
+struct Recorder;
+struct InteractionState;
 
 typedef U32 Id;
 constexpr Id Id_Invalid = 0;
 
+// String literal ID hashed at compile time (FNV-1a), e.g. MakeId(IM3D_STATIC_ID("axisX")). MakeId()/PushId() combine it with the ID stack
+// in a single step rather than hashing the string at runtime. Note that the result differs from MakeId("axisX").
+struct StaticId
+{
+	Id m_hash;
+	constexpr explicit StaticId(Id _hash): m_hash(_hash) {}
+};
+namespace internal {
+	constexpr U32 kFnv1aBase32  = 0x811C9DC5u;
+	constexpr U32 kFnv1aPrime32 = 0x01000193u;
+	constexpr Id  HashStatic(const char* _str, Id _hash = kFnv1aBase32) { return *_str ? HashStatic(_str + 1, (_hash ^ (Id)*_str) * kFnv1aPrime32) : _hash; }
+	template <Id kHash> struct StaticIdValue { static constexpr Id value = kHash; }; // forces compile time evaluation
+}
+#define IM3D_STATIC_ID(_str) ::Im3d::StaticId(::Im3d::internal::StaticIdValue< ::Im3d::internal::HashStatic(_str) >::value)
+
 // Get AppData struct from the current context, fill before calling NewFrame().
 IM3D_API AppData& GetAppData();
 
@@ -57,6 +82,9 @@ IM3D_API U32 GetDrawListCount();
 // Access to text draw data. Draw lists are valid after calling EndFrame() and before calling NewFrame().
 IM3D_API const TextDrawList* GetTextDrawLists();
 IM3D_API U32 GetTextDrawListCount();
+// Access to text quads, if AppData::m_font is set. Quad lists are valid after calling EndFrame() and before calling NewFrame().
+IM3D_API const TextQuadList* GetTextQuadLists();
+IM3D_API U32 GetTextQuadListCount();
 
 // DEPRECATED (use EndFrame() + GetDrawLists()).
 // Call after all Im3d calls have been made for the current frame.
@@ -160,12 +188,21 @@ IM3D_API void DrawConeFilled2(const Vec3& _start, const Vec3& _end, float _radiu
 // Add text. See TextFlags_ enum for _textFlags. _size is a hint to the application-side text rendering.
 IM3D_API void Text(const Vec3& _position, U32 _textFlags, const char* _text, ...); // use the current draw state for size/color
 IM3D_API void Text(const Vec3& _position, float _size, Color _color, U32 _textFlags, const char* _text, ...);
+// Add text without format parsing. _textEnd may be null if _textStart is null-terminated.
+IM3D_API void TextUnformatted(const Vec3& _position, U32 _textFlags, const char* _textStart, const char* _textEnd = nullptr); // use the current draw state for size/color
+IM3D_API void TextUnformatted(const Vec3& _position, float _size, Color _color, U32 _textFlags, const char* _textStart, const char* _textEnd = nullptr);
+// Store a string once in the context's persistent string table and return its ID (see Context::internText()). Add interned text via
+// TextInterned(), which avoids copying the string each frame.
+IM3D_API Id InternText(const char* _textStart, const char* _textEnd = nullptr);
+IM3D_API void TextInterned(const Vec3& _position, U32 _textFlags, Id _textId); // use the current draw state for size/color
+IM3D_API void TextInterned(const Vec3& _position, float _size, Color _color, U32 _textFlags, Id _textId);
 
 // IDs are used to uniquely identify gizmos and layers. Gizmo should have a unique ID during a frame.
 // Note that ids are a hash of the whole ID stack, see PushId(), PopId().
 IM3D_API Id MakeId(const char* _str);
 IM3D_API Id MakeId(const void* _ptr);
 IM3D_API Id MakeId(int _i);
+IM3D_API Id MakeId(StaticId _id);
 
 // PushId(), PopId() affect the result of subsequent calls to MakeId(), use when creating gizmos in a loop.
 IM3D_API void PushId(); // push stack top
@@ -173,6 +210,7 @@ IM3D_API void PushId(Id _id);
 IM3D_API void PushId(const char* _str);
 IM3D_API void PushId(const void* _ptr);
 IM3D_API void PushId(int _i);
+IM3D_API void PushId(StaticId _id);
 IM3D_API void PopId();
 IM3D_API Id   GetId();
 
@@ -199,6 +237,13 @@ IM3D_API bool GizmoScale(Id _id, float _scale_[3]);
 IM3D_API bool Gizmo(Id _id, float _transform_[4*4]);
 IM3D_API bool Gizmo(Id _id, float _translation_[3], float _rotation_[3*3], float _scale_[3]);
 
+// Group gizmo, e.g. for a multiple selection. Draws a single unified gizmo for _pivot_ and applies the change to _pivot_ to each of _count
+// transforms (T' = pivotAfter * inverse(pivotBefore) * T). _transforms_ are 4x4 matrices _stride bytes apart; alternatively pass arrays of
+// translations, 3x3 rotations and scales, any of which may be null. Set AppData::parallelForCallback to apply the change in parallel.
+// Return true if the gizmo is active and _pivot_ changed this frame, i.e. if the transforms were modified.
+IM3D_API bool GizmoGroup(Id _id, float _pivot_[4*4], float* _transforms_, U32 _count, U32 _stride = sizeof(float) * 4*4);
+IM3D_API bool GizmoGroup(Id _id, float _pivot_[4*4], float* _translations_, float* _rotations_, float* _scales_, U32 _count);
+
 // Return true once when the current gizmo is made active.
 IM3D_API bool GizmoWasActivated();
 
@@ -207,11 +252,34 @@ IM3D_API Id GetActiveId();
 // ID of the current current 'hot' gizmo (nearest intersecting gizmo along the cursor ray).
 IM3D_API Id GetHotId();
 
+// Object picking. Submit pickable world space volumes each frame; each is tested against the cursor ray immediately and only the nearest
+// hit is kept. After EndFrame(), GetPickId() returns the _id of the nearest volume hit by the cursor ray, or Id_Invalid if there was
+// no hit or a gizmo is hot/active (gizmos take priority as they are drawn on top of the scene).
+IM3D_API void PickSphere(Id _id, const Vec3& _origin, float _radius);
+IM3D_API void PickBox(Id _id, const Vec3& _min, const Vec3& _max); // axis-aligned bounding box
+IM3D_API void PickCapsule(Id _id, const Vec3& _start, const Vec3& _end, float _radius);
+// Batched picking, equivalent to calling PickSphere()/PickBox() for each of _count volumes.
+IM3D_API void PickSpheres(const Id* _ids, const Vec3* _origins, const float* _radii, U32 _count);
+IM3D_API void PickBoxes(const Id* _ids, const Vec3* _min, const Vec3* _max, U32 _count);
+IM3D_API Id   GetPickId();
+
 // Visibility tests. The application must set a culling frustum via AppData.
 IM3D_API bool IsVisible(const Vec3& _origin, float _radius); // sphere
 IM3D_API bool IsVisible(const Vec3& _min, const Vec3& _max); // axis-aligned bounding box
+// Batched visibility tests, equivalent to calling IsVisible() for each of _count volumes. Bit i of _visible_ is set if volume i is visible;
+// _visible_ must have space for (_count + 31) / 32 words.
+IM3D_API void IsVisible(const Vec3* _origins, const float* _radii, U32 _count, U32* _visible_); // spheres
+IM3D_API void IsVisible(const Vec3* _min, const Vec3* _max, U32 _count, U32* _visible_); // axis-aligned bounding boxes
+
+// Cull scopes. If the world space bounds are outside the cull frustum, or an enclosing scope was culled, vertices and text are
+// discarded until the matching PopCullBounds(). Use to skip drawing whole hierarchies. The application must set a culling frustum via AppData.
+IM3D_API void PushCullBounds(const Vec3& _min, const Vec3& _max);
+IM3D_API void PushCullSphere(const Vec3& _origin, float _radius);
+IM3D_API void PopCullBounds(); // pop either of the above
 
 // Get/set the current context. All Im3d calls affect the currently bound context.
+// If IM3D_THREAD_SAFE_SUBMISSION is enabled, GetContext() returns the calling thread's producer context (see Context::getThreadContext()).
+// If IM3D_CONTEXT_LOOKUP is defined, the bound context is the result of IM3D_CONTEXT_LOOKUP() and SetContext() has no effect.
 IM3D_API Context& GetContext();
 IM3D_API void SetContext(Context& _ctx);
 
@@ -219,6 +287,152 @@ IM3D_API void SetContext(Context& _ctx);
 IM3D_API void MergeContexts(Context& _dst_, const Context& _src);
 
 
+// Explicit context API. The following are equivalent to the functions of the same name above, but affect _ctx instead of the
+// current context. Use these to avoid repeated context lookups, or where a context is bound to a task rather than a thread.
+// Per-frame functions (NewFrame(), EndFrame(), GetDrawLists(), etc.) map directly to Context member functions.
+IM3D_API void BeginPoints(Context& _ctx);
+IM3D_API void BeginLines(Context& _ctx);
+IM3D_API void BeginLineLoop(Context& _ctx);
+IM3D_API void BeginLineStrip(Context& _ctx);
+IM3D_API void BeginTriangles(Context& _ctx);
+IM3D_API void BeginTriangleStrip(Context& _ctx);
+IM3D_API void End(Context& _ctx);
+
+IM3D_API void Vertex(Context& _ctx, const Vec3& _position);
+IM3D_API void Vertex(Context& _ctx, const Vec3& _position, Color _color);
+IM3D_API void Vertex(Context& _ctx, const Vec3& _position, float _size);
+IM3D_API void Vertex(Context& _ctx, const Vec3& _position, float _size, Color _color);
+IM3D_API void Vertex(Context& _ctx, float _x, float _y, float _z);
+IM3D_API void Vertex(Context& _ctx, float _x, float _y, float _z, Color _color);
+IM3D_API void Vertex(Context& _ctx, float _x, float _y, float _z, float _size);
+IM3D_API void Vertex(Context& _ctx, float _x, float _y, float _z, float _size, Color _color);
+
+IM3D_API void PushColor(Context& _ctx);
+IM3D_API void PushColor(Context& _ctx, Color _color);
+IM3D_API void PopColor(Context& _ctx);
+IM3D_API void SetColor(Context& _ctx, Color _color);
+IM3D_API void SetColor(Context& _ctx, float _r, float _g, float _b, float _a = 1.0f);
+IM3D_API Color GetColor(Context& _ctx);
+
+IM3D_API void PushAlpha(Context& _ctx);
+IM3D_API void PushAlpha(Context& _ctx, float _alpha);
+IM3D_API void PopAlpha(Context& _ctx);
+IM3D_API void SetAlpha(Context& _ctx, float _alpha);
+IM3D_API float GetAlpha(Context& _ctx);
+
+IM3D_API void PushSize(Context& _ctx);
+IM3D_API void PushSize(Context& _ctx, float _size);
+IM3D_API void PopSize(Context& _ctx);
+IM3D_API void SetSize(Context& _ctx, float _size);
+IM3D_API float GetSize(Context& _ctx);
+
+IM3D_API void PushEnableSorting(Context& _ctx);
+IM3D_API void PushEnableSorting(Context& _ctx, bool _enable);
+IM3D_API void PopEnableSorting(Context& _ctx);
+IM3D_API void EnableSorting(Context& _ctx, bool _enable);
+
+IM3D_API void PushDrawState(Context& _ctx);
+IM3D_API void PopDrawState(Context& _ctx);
+
+IM3D_API void PushMatrix(Context& _ctx);
+IM3D_API void PushMatrix(Context& _ctx, const Mat4& _mat4);
+IM3D_API void PopMatrix(Context& _ctx);
+IM3D_API void SetMatrix(Context& _ctx, const Mat4& _mat4);
+IM3D_API void SetIdentity(Context& _ctx);
+IM3D_API void MulMatrix(Context& _ctx, const Mat4& _mat4);
+IM3D_API void Translate(Context& _ctx, float _x, float _y, float _z);
+IM3D_API void Translate(Context& _ctx, const Vec3& _vec3);
+IM3D_API void Rotate(Context& _ctx, const Vec3& _axis, float _angle);
+IM3D_API void Rotate(Context& _ctx, const Mat3& _rotation);
+IM3D_API void Scale(Context& _ctx, float _x, float _y, float _z);
+
+IM3D_API void DrawXyzAxes(Context& _ctx);
+IM3D_API void DrawPoint(Context& _ctx, const Vec3& _position, float _size, Color _color);
+IM3D_API void DrawLine(Context& _ctx, const Vec3& _a, const Vec3& _b, float _size, Color _color);
+IM3D_API void DrawQuad(Context& _ctx, const Vec3& _a, const Vec3& _b, const Vec3& _c, const Vec3& _d);
+IM3D_API void DrawQuad(Context& _ctx, const Vec3& _origin, const Vec3& _normal, const Vec2& _size);
+IM3D_API void DrawQuadFilled(Context& _ctx, const Vec3& _a, const Vec3& _b, const Vec3& _c, const Vec3& _d);
+IM3D_API void DrawQuadFilled(Context& _ctx, const Vec3& _origin, const Vec3& _normal, const Vec2& _size);
+IM3D_API void DrawCircle(Context& _ctx, const Vec3& _origin, const Vec3& _normal, float _radius, int _detail = -1);
+IM3D_API void DrawCircleFilled(Context& _ctx, const Vec3& _origin, const Vec3& _normal, float _radius, int _detail = -1);
+IM3D_API void DrawSphere(Context& _ctx, const Vec3& _origin, float _radius, int _detail = -1);
+IM3D_API void DrawSphereFilled(Context& _ctx, const Vec3& _origin, float _radius, int _detail = -1);
+IM3D_API void DrawAlignedBox(Context& _ctx, const Vec3& _min, const Vec3& _max);
+IM3D_API void DrawAlignedBoxFilled(Context& _ctx, const Vec3& _min, const Vec3& _max);
+IM3D_API void DrawCylinder(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radius, int _detail = -1);
+IM3D_API void DrawCylinderFilled(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radius, bool _drawCapStart = true, bool _drawCapEnd = true, int _detail = -1);
+IM3D_API void DrawCapsule(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radius, int _detail = -1);
+IM3D_API void DrawPrism(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radius, int _sides);
+IM3D_API void DrawArrow(Context& _ctx, const Vec3& _start, const Vec3& _end, float _headLength = -1.0f, float _headThickness = -1.0f);
+IM3D_API void DrawCone2(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, int _detail = -1);
+IM3D_API void DrawConeFilled2(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, bool _drawCapStart = true, bool _drawCapEnd = true, int _detail = -1);
+#if IM3D_USE_DEPRECATED_DRAW_CONE
+	IM3D_API void DrawCone(Context& _ctx, const Vec3& _origin, const Vec3& _normal, float height, float _radius, int _detail = -1);
+	IM3D_API void DrawConeFilled(Context& _ctx, const Vec3& _origin, const Vec3& _normal, float height, float _radius, int _detail = -1);
+#else
+	IM3D_API inline void DrawCone(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, int _detail = -1) { DrawCone2(_ctx, _start, _end, _radiusStart, _radiusEnd, _detail); }
+	IM3D_API inline void DrawConeFilled(Context& _ctx, const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, bool _drawCapStart = true, bool _drawCapEnd = true, int _detail = -1) { DrawConeFilled2(_ctx, _start, _end, _radiusStart, _radiusEnd, _drawCapStart, _drawCapEnd, _detail); }
+#endif // IM3D_USE_DEPRECATED_DRAW_CONE
+
+IM3D_API void Text(Context& _ctx, const Vec3& _position, U32 _textFlags, const char* _text, ...);
+IM3D_API void Text(Context& _ctx, const Vec3& _position, float _size, Color _color, U32 _textFlags, const char* _text, ...);
+IM3D_API void TextUnformatted(Context& _ctx, const Vec3& _position, U32 _textFlags, const char* _textStart, const char* _textEnd = nullptr);
+IM3D_API void TextUnformatted(Context& _ctx, const Vec3& _position, float _size, Color _color, U32 _textFlags, const char* _textStart, const char* _textEnd = nullptr);
+IM3D_API Id InternText(Context& _ctx, const char* _textStart, const char* _textEnd = nullptr);
+IM3D_API void TextInterned(Context& _ctx, const Vec3& _position, U32 _textFlags, Id _textId);
+IM3D_API void TextInterned(Context& _ctx, const Vec3& _position, float _size, Color _color, U32 _textFlags, Id _textId);
+
+IM3D_API Id MakeId(Context& _ctx, const char* _str);
+IM3D_API Id MakeId(Context& _ctx, const void* _ptr);
+IM3D_API Id MakeId(Context& _ctx, int _i);
+IM3D_API Id MakeId(Context& _ctx, StaticId _id);
+
+IM3D_API void PushId(Context& _ctx);
+IM3D_API void PushId(Context& _ctx, Id _id);
+IM3D_API void PushId(Context& _ctx, const char* _str);
+IM3D_API void PushId(Context& _ctx, const void* _ptr);
+IM3D_API void PushId(Context& _ctx, int _i);
+IM3D_API void PushId(Context& _ctx, StaticId _id);
+IM3D_API void PopId(Context& _ctx);
+IM3D_API Id   GetId(Context& _ctx);
+
+IM3D_API void PushLayerId(Context& _ctx, Id _layer);
+IM3D_API void PushLayerId(Context& _ctx, const char* _str);
+IM3D_API void PopLayerId(Context& _ctx);
+IM3D_API Id   GetLayerId(Context& _ctx);
+
+IM3D_API bool GizmoTranslation(Context& _ctx, const char* _id, float _translation_[3], bool _local = false);
+IM3D_API bool GizmoRotation(Context& _ctx, const char* _id, float _rotation_[3*3], bool _local = false);
+IM3D_API bool GizmoScale(Context& _ctx, const char* _id, float _scale_[3]);
+IM3D_API bool Gizmo(Context& _ctx, const char* _id, float _translation_[3], float _rotation_[3*3], float _scale_[3]);
+IM3D_API bool Gizmo(Context& _ctx, const char* _id, float _transform_[4*4]);
+IM3D_API bool GizmoTranslation(Context& _ctx, Id _id, float _translation_[3], bool _local = false);
+IM3D_API bool GizmoRotation(Context& _ctx, Id _id, float _rotation_[3*3], bool _local = false);
+IM3D_API bool GizmoScale(Context& _ctx, Id _id, float _scale_[3]);
+IM3D_API bool Gizmo(Context& _ctx, Id _id, float _transform_[4*4]);
+IM3D_API bool Gizmo(Context& _ctx, Id _id, float _translation_[3], float _rotation_[3*3], float _scale_[3]);
+IM3D_API bool GizmoGroup(Context& _ctx, Id _id, float _pivot_[4*4], float* _transforms_, U32 _count, U32 _stride = sizeof(float) * 4*4);
+IM3D_API bool GizmoGroup(Context& _ctx, Id _id, float _pivot_[4*4], float* _translations_, float* _rotations_, float* _scales_, U32 _count);
+IM3D_API bool GizmoWasActivated(Context& _ctx);
+IM3D_API Id   GetActiveId(Context& _ctx);
+IM3D_API Id   GetHotId(Context& _ctx);
+
+IM3D_API void PickSphere(Context& _ctx, Id _id, const Vec3& _origin, float _radius);
+IM3D_API void PickBox(Context& _ctx, Id _id, const Vec3& _min, const Vec3& _max);
+IM3D_API void PickCapsule(Context& _ctx, Id _id, const Vec3& _start, const Vec3& _end, float _radius);
+IM3D_API void PickSpheres(Context& _ctx, const Id* _ids, const Vec3* _origins, const float* _radii, U32 _count);
+IM3D_API void PickBoxes(Context& _ctx, const Id* _ids, const Vec3* _min, const Vec3* _max, U32 _count);
+IM3D_API Id   GetPickId(Context& _ctx);
+
+IM3D_API bool IsVisible(Context& _ctx, const Vec3& _origin, float _radius);
+IM3D_API bool IsVisible(Context& _ctx, const Vec3& _min, const Vec3& _max);
+IM3D_API void IsVisible(Context& _ctx, const Vec3* _origins, const float* _radii, U32 _count, U32* _visible_);
+IM3D_API void IsVisible(Context& _ctx, const Vec3* _min, const Vec3* _max, U32 _count, U32* _visible_);
+IM3D_API void PushCullBounds(Context& _ctx, const Vec3& _min, const Vec3& _max);
+IM3D_API void PushCullSphere(Context& _ctx, const Vec3& _origin, float _radius);
+IM3D_API void PopCullBounds(Context& _ctx);
+
+
 struct IM3D_API Vec2
 {
 	float x, y;
@@ -465,6 +679,10 @@ struct DrawList
 };
 typedef void (DrawPrimitivesCallback)(const DrawList& _drawList);
 
+// Parallel for, see AppData::parallelForCallback.
+typedef void (ParallelForJob)(void* _jobData, U32 _begin, U32 _end);
+typedef void (ParallelForCallback)(ParallelForJob* _job, void* _jobData, U32 _count);
+
 enum TextFlags
 {
 	TextFlags_AlignLeft    = (1 << 0),
@@ -492,6 +710,42 @@ struct TextDrawList
 	const char*     m_textBuffer;
 };
 
+// Font atlas description for the built-in text layout, see AppData::m_font. Metrics are in pixels at text size 1, y down.
+struct FontGlyph
+{
+	Vec2      m_uvMin;            // atlas texture coordinates of the glyph quad
+	Vec2      m_uvMax;
+	Vec2      m_offset;           // offset from the pen position (top of the line) to the top left corner of the quad
+	Vec2      m_size;             // quad size, 0 for whitespace
+	float     m_advance;          // horizontal pen advance
+};
+
+struct Font
+{
+	const FontGlyph* m_glyphs     = nullptr;
+	U32              m_firstChar  = 32;   // character code of m_glyphs[0], characters outside [m_firstChar, m_firstChar + m_glyphCount) are skipped
+	U32              m_glyphCount = 0;
+	float            m_lineHeight = 0.0f; // vertical pen advance per '\n'
+};
+
+// Text quad vertex. The quad corner is at m_position projected to screen space + m_offset pixels (y down), hence the renderer expands
+// quads in the vertex shader, e.g. clip.xy += m_offset * vec2(2.0, -2.0) / viewportSize * clip.w.
+struct alignas(IM3D_VERTEX_ALIGNMENT) TextVertex
+{
+	Vec3      m_position;         // world space anchor (TextData::m_positionSize.xyz)
+	Vec2      m_offset;           // pixel offset from the projected anchor
+	Vec2      m_uv;               // atlas texture coordinates
+	Color     m_color;
+};
+
+// Triangle list (6 vertices per glyph) containing all text in a layer.
+struct TextQuadList
+{
+	Id                m_layerId;
+	const TextVertex* m_vertexData;
+	U32               m_vertexCount;
+};
+
 enum Key
 {
 	Mouse_Left,
@@ -541,15 +795,72 @@ struct AppData
 	float  m_snapRotation                    = 0.0f;                    // Snap value for rotation gizmos (radians). 0 = disabled.
 	float  m_snapScale                       = 0.0f;                    // Snap value for scale gizmos. 0 = disabled.
 	bool   m_flipGizmoWhenBehind             = true;                    // Flip gizmo axes when viewed from behind.
+	bool   m_deferHotResolution              = false;                   // Resolve the hot gizmo during EndFrame() from all gizmos evaluated this frame (and merged contexts), see Context::makeHot().
+	float  m_minPixelSize                    = 0.0f;                    // Shapes and Begin*()/End() primitives whose projected size (pixels) is smaller than this are culled. 0 = disabled.
+	bool   m_minPixelSizeAsPoint             = false;                   // Draw shapes smaller than m_minPixelSize as a single point instead of culling them.
+	const OcclusionBuffer* m_occlusionBuffer = nullptr;                 // Software depth buffer for occlusion culling (see OcclusionBuffer). nullptr = disabled.
+	U32    m_flushVertexCount                = 0;                       // Streaming mode, see flushCallback. 0 = disabled.
+	const Font* m_font                       = nullptr;                 // Font atlas for the built-in text layout (see TextQuadList). nullptr = disabled.
+	Mat4   m_viewProj                        = Mat4(1.0f);              // View-projection matrix, set by setCullFrustum(). Used for text decluttering (m_textDeclutterSize).
+	float  m_textDeclutterSize               = 0.0f;                    // Screen space cell size (pixels) for text decluttering, only the nearest label per cell in each layer is kept (requires m_viewProj). 0 = disabled.
 	void*  m_appData                         = nullptr;                 // App-specific data.
 
 	DrawPrimitivesCallback* drawCallback     = nullptr; // e.g. void Im3d_Draw(const DrawList& _drawList)
 
-	// Extract cull frustum planes from the view-projection matrix.
+	// Streaming mode: when an unsorted vertex list reaches m_flushVertexCount at End(), it is passed to flushCallback and its memory reused.
+	// Peak memory is then bounded by m_flushVertexCount plus the largest Begin*()/End() block. Flushed primitives bypass EndFrame()
+	// processing (post-pass culling, compaction, views) and are not included in the draw lists. With IM3D_THREAD_SAFE_SUBMISSION the
+	// callback may be called from any submitting thread.
+	DrawPrimitivesCallback* flushCallback    = nullptr;
+
+	// Optional, used to apply GizmoGroup() changes in parallel. Must call _job(_jobData, begin, end) for disjoint ranges which cover
+	// [0, _count), from any threads, and return once all calls have completed.
+	ParallelForCallback* parallelForCallback = nullptr;
+
+	// Extract cull frustum planes from the view-projection matrix and store it in m_viewProj.
 	// Set _ndcZNegativeOneToOne = true if the proj matrix maps z from [-1,1] (OpenGL style).
 	void setCullFrustum(const Mat4& _viewProj, bool _ndcZNegativeOneToOne);
 };
 
+// Per-frame constants derived from AppData. By default each context derives its own during reset(). Alternatively, call update() once
+// per frame and share the result between many contexts via Context::setFrameConstants(); their reset() then skips this work and all
+// contexts are guaranteed to see the same view data.
+struct IM3D_API FrameConstants
+{
+	AppData* m_appData                        = nullptr;   // App data from which the constants were derived.
+	bool     m_keyDownCurr[Key_Count]         = { false }; // Key state captured during update().
+	bool     m_keyDownPrev[Key_Count]         = { false }; // Key state from the previous update().
+	Vec4     m_cullFrustum[FrustumPlane_Count];            // Valid frustum planes from m_appData->m_cullFrustum.
+	int      m_cullFrustumCount               = 0;         // # valid frustum planes in m_cullFrustum.
+
+	// Derive constants from _appData_, which must remain valid and unmodified while any context references this instance.
+	// _appData_.m_viewDirection is normalized in place.
+	void update(AppData& _appData_);
+};
+
+// Gizmo interaction state shared between contexts, e.g. worker contexts which evaluate gizmos in parallel (see Context::setInteractionState()).
+// Each context copies the resolved state during reset(). Hot candidates from all contexts are reduced to the nearest by an atomic
+// compare-and-swap during the frame, hence at most one gizmo is hot or active across all of the contexts. As per
+// AppData::m_deferHotResolution, the result applies from the next frame.
+struct IM3D_API InteractionState
+{
+	Id       m_hotId           = Id_Invalid;  // Resolved state, see Context::m_hotId etc.
+	Id       m_appHotId        = Id_Invalid;  //               "
+	float    m_hotDepth        = 0.0f;        //               "
+	Id       m_activeId        = Id_Invalid;  //               "
+	Id       m_appActiveId     = Id_Invalid;  //               "
+	Vec3     m_gizmoStateVec3  = Vec3(0.0f);  // Stored state for the active gizmo, from the context which activated it.
+	Mat3     m_gizmoStateMat3  = Mat3(1.0f);  //               "
+	float    m_gizmoStateFloat = 0.0f;        //               "
+
+	U64      m_hotCandidate    = ~0ull;       // Nearest hot candidate this frame, packed depth + context serial (smaller = nearer).
+	Context* m_submitted       = nullptr;     // Lock-free list of contexts which submitted a hot candidate or an activation change this frame.
+
+	// Resolve the hot/active gizmo from the submissions of all referencing contexts. Call once per frame after every referencing context
+	// has called endFrame() and before any of them calls reset(); referencing contexts must not be destroyed in between.
+	void resolve();
+};
+
 // Minimal vector.
 template <typename T>
 struct Vector
@@ -595,6 +906,74 @@ private:
 	U32  m_capacity = 0;
 };
 
+// Low resolution software depth buffer for occlusion culling. Each frame the app calls begin(), rasterizes occluder triangles, calls end()
+// and then sets AppData::m_occlusionBuffer. Primitives on layers which opt in via LayerPolicy::m_occlusionCulling are culled during
+// EndFrame() if they are entirely hidden by the occluders; shape helpers test their bounds before generating any vertices.
+// Depth is assumed to increase with distance from the view origin (i.e. not reversed-Z).
+struct IM3D_API OcclusionBuffer
+{
+	                OcclusionBuffer(U32 _width = 256, U32 _height = 128);
+
+	// Set the view-projection matrix and clear the buffer.
+	void            begin(const Mat4& _viewProj);
+	// Rasterize a triangle list (3 vertices per triangle) transformed by _world. Only rows [_rowBegin, _rowEnd) are written, hence
+	// different threads may rasterize concurrently as long as their row ranges don't overlap. Only texels entirely covered by a single
+	// triangle store depth, so texels along edges shared between triangles remain empty; prefer few, large occluder triangles.
+	void            rasterize(const Vec3* _vertices, U32 _vertexCount, const Mat4& _world, U32 _rowBegin = 0, U32 _rowEnd = ~0u);
+	// Build the hierarchical depth buffer; call once after all calls to rasterize() have completed.
+	void            end();
+
+	// Return true if the axis-aligned box/sphere is entirely hidden by the occluders.
+	bool            isOccluded(const Vec3& _min, const Vec3& _max) const;
+	bool            isOccluded(const Vec3& _origin, float _radius) const;
+	// Return true if the NDC rectangle [_min, _max] with nearest NDC depth _depth is entirely hidden by the occluders. Depth is compared
+	// as standard Z (farther is greater); reversed-Z projections are not supported.
+	bool            isOccluded(const Vec2& _min, const Vec2& _max, float _depth) const;
+
+	U32             getWidth() const                 { return m_width;  }
+	U32             getHeight() const                { return m_height; }
+	U32             getLevelCount() const            { return m_levelCount; }
+	// Return depth values for _level; level 0 is the nearest occluder depth per texel, each subsequent level is the farthest of the
+	// corresponding 2x2 texels in the level above. Empty texels are FLT_MAX.
+	const float*    getDepth(U32 _level = 0) const   { IM3D_ASSERT(_level < m_levelCount); return m_depth.data() + m_levelOffset[_level]; }
+
+private:
+
+	enum { kMaxLevels = 16 };
+
+	Mat4            m_viewProj;
+	U32             m_width;
+	U32             m_height;
+	U32             m_levelCount;
+	U32             m_levelWidth[kMaxLevels];
+	U32             m_levelHeight[kMaxLevels];
+	U32             m_levelOffset[kMaxLevels];           // Offset of each level in m_depth.
+	Vector<float>   m_depth;
+
+	void            rasterizeTriangle(Vec3 _a, Vec3 _b, Vec3 _c, U32 _rowBegin, U32 _rowEnd);
+};
+
+// Per-layer culling policy, see Context::setLayerPolicy(). Distances are measured from AppData::m_viewOrigin.
+struct LayerPolicy
+{
+	float  m_maxDistance                     = 0.0f;                    // Shapes and Begin*()/End() primitives farther than this are culled. 0 = disabled.
+	float  m_fadeDistance                    = 0.0f;                    // Vertex alpha fades out over this distance before m_maxDistance. 0 = disabled.
+	float  m_lodBias                         = 1.0f;                    // Scales the automatic level of detail of shape helpers (_detail < 0).
+	bool   m_occlusionCulling                = false;                   // Cull against AppData::m_occlusionBuffer.
+};
+
+// Camera for multi-view output, see Context::setViews(). Members match the corresponding AppData members.
+struct IM3D_API View
+{
+	Vec4   m_cullFrustum[FrustumPlane_Count] = { Vec4(0.0f) };          // Frustum planes for culling, planes with a zero normal are ignored.
+	Vec3   m_viewOrigin                      = Vec3(0.0f);              // World space render origin (camera position).
+	Vec2   m_viewportSize                    = Vec2(0.0f);              // Viewport size (pixels).
+	float  m_projScaleY                      = 1.0f;                    // Scale factor used to convert from pixel size -> world scale.
+	bool   m_projOrtho                       = false;                   // If the projection matrix is orthographic.
+
+	// Extract cull frustum planes from the view-projection matrix, see AppData::setCullFrustum().
+	void setCullFrustum(const Mat4& _viewProj, bool _ndcZNegativeOneToOne);
+};
 
 enum PrimitiveMode
 {
@@ -628,6 +1007,18 @@ struct IM3D_API Context
 	void                text(const Vec3& _position, float _size, Color _color, TextFlags _flags, const char* _textStart, const char* _textEnd);
 	void                text(const Vec3& _position, float _size, Color _color, TextFlags _flags, const char* _text, va_list _args);
 
+	// Interned text. internText() stores a string once in a persistent per-context table and returns its ID (a hash of the string,
+	// independent of the ID stack, or the next free ID on a hash collision); text() then references the stored string instead of copying
+	// it. Interned strings are stored at the start of the text buffer, their TextData::m_textBufferOffset is stable across frames. Producer
+	// contexts (IM3D_THREAD_SAFE_SUBMISSION) hold a copy of the parent's table as of the parent's last reset(), hence strings interned on
+	// the parent are available to other threads from the next frame; strings interned on a producer are discarded when the parent's table
+	// changes. The app must not call internText() on the parent while other threads are submitting. Adding a string may reallocate the text
+	// buffer, hence text draw lists returned by endFrame() are invalidated.
+	Id                  internText(const char* _textStart, const char* _textEnd = nullptr);
+	void                text(const Vec3& _position, float _size, Color _color, TextFlags _flags, Id _textId);
+	// Remove all interned strings; text which already references them remains valid until reset().
+	void                clearInternedText();
+
 	void                reset();
 	void                merge(const Context& _src);
 	void                endFrame();
@@ -636,8 +1027,20 @@ struct IM3D_API Context
 	const DrawList*     getDrawLists() const             { return m_drawLists.data(); }
 	U32                 getDrawListCount() const         { return m_drawLists.size(); }
 
+	// Multi-view output. If views are set, endFrame() additionally produces draw lists per view over the shared vertex data; primitives are
+	// culled against each view's frustum and sorted primitives are sorted relative to each view's origin. Automatic LOD is chosen for the
+	// nearest view. Views persist until the next call to setViews().
+	void                setViews(const View* _views, U32 _count);
+	U32                 getViewCount() const             { return m_views.size(); }
+	const View&         getView(U32 _view) const         { return m_views[_view]; }
+	const DrawList*     getViewDrawLists(U32 _view) const      { return m_viewDrawLists.data() + m_viewDrawListStart[_view]; }
+	U32                 getViewDrawListCount(U32 _view) const  { return m_viewDrawListStart[_view + 1] - m_viewDrawListStart[_view]; }
+
 	const TextDrawList* getTextDrawLists() const         { return m_textDrawLists.data();  }
 	U32                 getTextDrawListCount() const     { return m_textDrawLists.size();  }
+	// Text quads generated from the text draw lists during endFrame() if AppData::m_font is set, one list per layer.
+	const TextQuadList* getTextQuadLists() const         { return m_textQuadLists.data();  }
+	U32                 getTextQuadListCount() const     { return m_textQuadLists.size();  }
 
 
 	void                setColor(Color _color)           { m_colorStack.back() = _color;   }
@@ -675,7 +1078,36 @@ struct IM3D_API Context
 	void                popId()                          { IM3D_ASSERT(m_idStack.size() > 1); m_idStack.pop_back(); }
 	bool                idWasActivated()                 { return m_appId != Id_Invalid && m_appIdActivated == m_appId; }
 
-	AppData&            getAppData()                     { return m_appData; }
+	void                pushCullBounds(const Vec3& _min, const Vec3& _max);
+	void                pushCullSphere(const Vec3& _origin, float _radius);
+	void                popCullBounds();
+	bool                isCullScopeCulled() const        { return m_cullScopeCulled; }
+
+	// Set the culling policy for _layerId (adding the layer if necessary). Policies persist between frames.
+	void                setLayerPolicy(Id _layerId, const LayerPolicy& _policy);
+	// Return the policy for _layerId, or the default policy if the layer doesn't exist.
+	const LayerPolicy&  getLayerPolicy(Id _layerId) const;
+	// Return the policy for the current layer.
+	const LayerPolicy&  getLayerPolicy() const           { return m_layerPolicies[m_layerIndex]; }
+
+	// Return the app data used by this context; this is the shared app data if setFrameConstants() was called.
+	AppData&            getAppData()                     { return *m_frameConstants->m_appData; }
+
+	// Reference shared per-frame constants instead of deriving them from the context's own app data during reset(). The change takes
+	// effect immediately; pass nullptr to revert to the context's own app data.
+	void                setFrameConstants(const FrameConstants* _frameConstants);
+	const FrameConstants& getFrameConstants() const      { return *m_frameConstants; }
+
+	// Reference gizmo interaction state shared with other contexts (see InteractionState), pass nullptr to revert to the context's own
+	// state. The change takes effect from the next reset(). Producer contexts merge into their parent, which submits on their behalf.
+	void                setInteractionState(InteractionState* _interactionState) { m_interactionState = _interactionState; }
+	InteractionState*   getInteractionState() const      { return m_interactionState; }
+
+	// Return the context to which the calling thread should submit. If IM3D_THREAD_SAFE_SUBMISSION is enabled, threads other than the
+	// one which called reset() get a producer context owned by this context; producers are created on first use, reset along with this
+	// context and merged into it during endFrame(). Producers which their thread hasn't requested for IM3D_PRODUCER_IDLE_FRAMES frames are
+	// destroyed during reset(), hence don't keep a reference to a producer across frames. Otherwise return *this.
+	Context&            getThreadContext();
 
  // Low-level interface for internal and app-defined gizmos. May be subject to breaking changes.
 
@@ -698,7 +1130,8 @@ struct IM3D_API Context
 	// Blend between _min and _max based on distance betwen _position and view origin.
 	int                 estimateLevelOfDetail(const Vec3& _position, float _worldSize, int _min = 4, int _max = 256);
 
-	// Make _id hot if _depth < m_hotDepth && _intersects.
+	// Make _id hot if _depth < m_hotDepth && _intersects. If AppData::m_deferHotResolution is set, _id is instead recorded as a candidate
+	// and the nearest candidate becomes hot during endFrame(); the current hot gizmo must call makeHot() each frame to remain hot.
 	bool                makeHot(Id _id, float _depth, bool _intersects);
 	// Make _id active.
 	void                makeActive(Id _id);
@@ -706,13 +1139,30 @@ struct IM3D_API Context
 	void                resetId();
 
 	// Interpret key state.
-	bool                isKeyDown(Key _key) const     { return m_keyDownCurr[_key]; }
-	bool                wasKeyPressed(Key _key) const { return m_keyDownCurr[_key] && !m_keyDownPrev[_key]; }
+	bool                isKeyDown(Key _key) const     { return m_frameConstants->m_keyDownCurr[_key]; }
+	bool                wasKeyPressed(Key _key) const { return m_frameConstants->m_keyDownCurr[_key] && !m_frameConstants->m_keyDownPrev[_key]; }
 
 	// Visibiity tests for culling.
 	bool                isVisible(const VertexData* _vdata, DrawPrimitiveType _prim); // per-vertex
 	bool                isVisible(const Vec3& _origin, float _radius);                // sphere
 	bool                isVisible(const Vec3& _min, const Vec3& _max);                // axis-aligned box
+	// Batched tests (see Im3d::IsVisible()), use SSE if available.
+	void                isVisible(const Vec3* _origins, const float* _radii, U32 _count, U32* _visible_); // spheres
+	void                isVisible(const Vec3* _min, const Vec3* _max, U32 _count, U32* _visible_);       // axis-aligned boxes
+	// Occlusion tests against AppData::m_occlusionBuffer, always false unless occlusion culling is enabled for the current layer.
+	bool                isOccluded(const Vec3& _origin, float _radius);                // sphere
+	bool                isOccluded(const Vec3& _min, const Vec3& _max);                // axis-aligned box
+
+	// Picking (see Im3d::PickSphere()). Volumes are in world space, depth is the distance along the cursor ray.
+	void                pickSphere(Id _id, const Vec3& _origin, float _radius);
+	void                pickBox(Id _id, const Vec3& _min, const Vec3& _max);
+	void                pickCapsule(Id _id, const Vec3& _start, const Vec3& _end, float _radius);
+	// Batched tests, use SSE if available.
+	void                pickSpheres(const Id* _ids, const Vec3* _origins, const float* _radii, U32 _count);
+	void                pickBoxes(const Id* _ids, const Vec3* _min, const Vec3* _max, U32 _count);
+	// Nearest picked volume, resolved against the gizmos during endFrame().
+	Id                  getPickId() const                { return m_pickId;    }
+	float               getPickDepth() const             { return m_pickDepth; }
 
  // Gizmo state.
 
@@ -730,6 +1180,18 @@ struct IM3D_API Context
 	float               m_gizmoStateFloat;    //               "
 	float               m_gizmoHeightPixels;  // Height/radius of gizmos.
 	float               m_gizmoSizePixels;    // Thickness of gizmo lines.
+	Id                  m_hotCandidateId;     // Nearest gizmo passed to makeHot() this frame, see AppData::m_deferHotResolution.
+	Id                  m_appHotCandidateId;  //               "
+	float               m_hotCandidateDepth;  //               "
+	Id                  m_activeIdAtReset;    // m_activeId at the start of the frame, for merging activation changes in deferred mode.
+	bool                m_deferHot;           // AppData::m_deferHotResolution or m_interactionState, set during reset().
+	InteractionState*   m_interactionState;   // See setInteractionState().
+	Context*            m_interactionNext;    // Next context in m_interactionState->m_submitted.
+
+ // Picking state.
+
+	Id                  m_pickId;             // Nearest picked volume (see pickSphere()), Id_Invalid if none.
+	float               m_pickDepth;          // Depth of m_pickId along the cursor ray.
 
 
  // Stats, debugging.
@@ -737,9 +1199,20 @@ struct IM3D_API Context
 	// Return the total number of primitives (sorted + unsorted) of the given _type in all layers.
 	U32                 getPrimitiveCount(DrawPrimitiveType _type) const;
 
+	// Return the number of primitives of the given _type removed by culling during the current frame (see IM3D_CULL_PRIMITIVES,
+	// IM3D_CULL_PRIMITIVES_POST_PASS, IM3D_COMPACT_PRIMITIVES, OcclusionBuffer, LayerPolicy).
+	U32                 getCulledPrimitiveCount(DrawPrimitiveType _type) const;
+
+	// Return the fraction of primitives of the given _type removed by culling during the current frame (culled / (culled + remaining)).
+	float               getCullRate(DrawPrimitiveType _type) const;
+
 	// Return the total number of text primitives in all layers.
 	U32                 getTextCount() const;
 
+	// Return the number of text primitives removed by culling and decluttering during the current frame (see IM3D_CULL_TEXT,
+	// AppData::m_textDeclutterSize).
+	U32                 getCulledTextCount() const       { return m_culledTextCount; }
+
 	// Return the number of layers.
 	U32                 getLayerCount() const { return m_layerIdMap.size(); }
 
@@ -753,6 +1226,8 @@ private:
 	Vector<Mat4>        m_matrixStack;
 	Vector<Id>          m_idStack;
 	Vector<Id>          m_layerIdStack;
+	Vector<bool>        m_cullScopeStack;
+	bool                m_cullScopeCulled;                  // = m_cullScopeStack.back(), vertices/text are discarded if true.
 
  // Vertex data: one list per layer, per primitive type, *2 for sorted/unsorted.
 	typedef Vector<VertexData> VertexList;
@@ -760,15 +1235,36 @@ private:
 	int                 m_vertexDataIndex;                  // 0, or 1 if sorting enabled.
 	Vector<Id>          m_layerIdMap;                       // Map Id -> vertex data index.
 	int                 m_layerIndex;                       // Index of the currently active layer in m_layerIdMap.
+	Vector<LayerPolicy> m_layerPolicies;                    // Per layer, parallel to m_layerIdMap.
 	Vector<DrawList>    m_drawLists;                        // All draw lists for the current frame, available after calling endFrame() before calling reset().
+	Vector<View>        m_views;                            // See setViews().
+	Vector<VertexList*> m_viewVertexData;                   // Per view, culled/sorted vertices gathered from m_vertexData.
+	Vector<DrawList>    m_viewDrawLists;                    // Draw lists for all views.
+	Vector<U32>         m_viewDrawListStart;                // Index of the first draw list per view in m_viewDrawLists, +1 for the end of the last view.
 	bool                m_sortCalled;                       // Avoid calling sort() during every call to draw().
 	bool                m_endFrameCalled;                   // For assert, if vertices are pushed after endFrame() was called.
+	U32                 m_culledPrimitiveCount[DrawPrimitive_Count];
+	Vector<U32>         m_primitiveKeep;                    // Bitset per primitive in the vertex list being compacted, see compactVertexList().
 
  // Text data: one list per layer.
 	typedef Vector<TextData> TextList;
 	Vector<TextList*>    m_textData;
 	Vector<char>         m_textBuffer;
 	Vector<TextDrawList> m_textDrawLists;
+	Vector<TextVertex>   m_textVertexData;                 // Text quads for all layers, see layoutText().
+	Vector<TextQuadList> m_textQuadLists;
+	Vector<U32>          m_textDeclutterCells;             // Hash table for decluttering, triples of cell key + text index + clip w.
+	Vector<U32>          m_textKeep;                       // Bitset per text in the current layer, cleared for text rejected by cullText().
+	Vector<U32>          m_textIntern;                     // Interned strings, triples of ID + offset in m_textBuffer + length, in order of offset.
+	Vector<U32>          m_textInternSlots;                // Hash table ID -> index in m_textIntern + 1 (0 = empty).
+	U32                  m_textInternSize;                 // m_textBuffer is truncated to this size by reset().
+	bool                 m_textInternDirty;                // Interned strings were added/removed, compact the buffer during reset().
+	U32                  m_textInternVersion;              // Incremented when interned strings are added/removed.
+	U32                  m_textInternSharedVersion;        // m_textInternVersion when m_textInternShared* were copied; for producers the parent's value last copied by syncProducer().
+	Vector<char>         m_textInternSharedText;           // Copy of the interned strings and table as of the last reset(), producers copy these (see syncProducer()).
+	Vector<U32>          m_textInternSharedTable;
+	Vector<U32>          m_textInternSharedSlots;
+	U32                  m_culledTextCount;
 
  // Primitive state.
 	PrimitiveMode       m_primMode;
@@ -777,23 +1273,167 @@ private:
 	U32                 m_vertCountThisPrim;                // # calls to vertex() since the last call to begin().
 	Vec3                m_minVertThisPrim;
 	Vec3                m_maxVertThisPrim;
+	bool                m_discardThisPrim;                  // Cull scope was culled or alpha is 0, vertex() discards all vertices.
+	bool                m_fadeThisPrim;                     // Layer policy has a distance fade, see m_layerPolicyThisPrim.
+	LayerPolicy         m_layerPolicyThisPrim;              // Copied from the current layer by begin(), avoids the per-vertex lookup.
+	Vec3                m_viewOriginThisPrim;               // AppData::m_viewOrigin, copied by begin().
+
+ // Gizmo geometry cache.
+	Vector<float>       m_gizmoRingCache;                   // Unit circles per level of detail, see getGizmoRing().
+	Vector<U32>         m_gizmoRingOffsets;                 // Per level of detail, index of the unit circle in m_gizmoRingCache + 1 (0 = not generated).
+	Vector<VertexData>  m_gizmoVertices;                    // Scratch for transformed gizmo geometry, passed to vertices().
 
  // App data.
 	AppData             m_appData;
-	bool                m_keyDownCurr[Key_Count];           // Key state captured during reset().
-	bool                m_keyDownPrev[Key_Count];           // Key state from previous frame.
-	Vec4                m_cullFrustum[FrustumPlane_Count];  // Optimized frustum planes from m_appData.m_cullFrustum.
-	int                 m_cullFrustumCount;                 // # valid frustum planes in m_cullFrustum.
+	FrameConstants      m_localFrameConstants;              // Derived from m_appData during reset().
+	const FrameConstants* m_frameConstants;                 // &m_localFrameConstants, or shared constants set via setFrameConstants().
+
+ // Thread-safe submission (IM3D_THREAD_SAFE_SUBMISSION).
+	U32                 m_serial;                           // Unique per context, keys the per-thread producer cache.
+	const void*         m_ownerThread;                      // Thread which last called reset().
+	const void*         m_producerThread;                   // Thread which submits to this context if it is a producer.
+	Context*            m_producerParent;                   // Owning context if this is a producer, else null.
+	Context*            m_producerNext;                     // Next producer in the parent's list.
+	Context*            m_producerHead;                     // Lock-free list of per-thread producers.
+	U32                 m_producerLastFrame;                // Parent's m_frameIndex when getThreadContext() last returned this producer.
+	U32                 m_producerGeneration;               // Incremented when reset() destroys idle producers, invalidates cached producers.
+	U32                 m_frameIndex;                       // Incremented by reset().
+
+	// Copy frame state from this context to _producer_ and reset it.
+	void                syncProducer(Context& _producer_);
+
+	// Reduce the hot candidate into m_interactionState->m_hotCandidate if it is nearer.
+	void                submitHotCandidate();
 
 	// Sort primitive data.
 	void                sort();
 
+	// Build m_viewDrawLists (see setViews()).
+	void                buildViewDrawLists();
+
+	// Remove individual primitives outside the cull frustum (IM3D_CULL_PRIMITIVES_POST_PASS).
+	void                cullPrimitives();
+	// Remove fully transparent/degenerate primitives (IM3D_COMPACT_PRIMITIVES).
+	void                compactPrimitives();
+	// Remove individual primitives hidden by AppData::m_occlusionBuffer in layers with LayerPolicy::m_occlusionCulling.
+	void                occludePrimitives();
+	bool                isOccluded(const VertexData* _vdata, DrawPrimitiveType _prim);
+	// Remove primitives whose bit is clear in m_primitiveKeep from _vertexList_ and add them to m_culledPrimitiveCount.
+	void                compactVertexList(VertexList& _vertexList_, DrawPrimitiveType _primType);
+
+	// Remove text outside the cull frustum (IM3D_CULL_TEXT) and overlapping labels (AppData::m_textDeclutterSize).
+	void                cullText();
+	// Return the index of _textId in m_textIntern, or -1 if not found.
+	int                 findInternedText(Id _textId) const;
+	// Generate m_textQuadLists from m_textDrawLists using AppData::m_font.
+	void                layoutText();
+
+	// Pass the unsorted vertex list for _layerIndex, _primType to AppData::flushCallback and clear it if it reached AppData::m_flushVertexCount.
+	void                flushVertexList(int _layerIndex, DrawPrimitiveType _primType);
+
+	// Append _count vertices to the current primitive (points, lines or triangles) in a single pass. Positions are already transformed (the
+	// matrix stack is ignored), otherwise as per vertex().
+	void                vertices(const VertexData* _vertices, U32 _count);
+
+	// Return the unit circle with _detail segments, generated on first use: _detail cosines, then _detail sines starting at the next
+	// multiple of 4. Valid until the next call.
+	const float*        getGizmoRing(int _detail);
+
 	// Return -1 if _id not found.
 	int                 findLayerIndex(Id _id) const;
 
 	// Access the current vertex/text data based on m_layerIndex.
 	VertexList*         getCurrentVertexList();
 	TextList*           getCurrentTextList();
+
+	friend struct Recorder;
+	friend struct InteractionState;
+};
+
+// Recorder is a lightweight alternative to Context for fine-grained tasks which draw a small number of primitives, e.g. one per job.
+// Draw state (color, alpha, size, sorting, layer, matrix) is copied from the parent context on construction; there are no state stacks.
+// Vertex data is stored inline, the heap is only used if more than IM3D_RECORDER_INLINE_VERTEX_COUNT vertices are recorded.
+// Primitives are appended to the parent context by submit() or on destruction. If IM3D_THREAD_SAFE_SUBMISSION is enabled, they are
+// appended to the calling thread's producer context (see Context::getThreadContext()).
+struct IM3D_API Recorder
+{
+	                    Recorder(Context& _parent);
+	                    ~Recorder();
+
+	void                begin(PrimitiveMode _mode);
+	void                end();
+
+	void                vertex(const Vec3& _position, float _size, Color _color);
+	void                vertex(const Vec3& _position)    { vertex(_position, m_size, m_color); }
+
+	// Append recorded primitives to the parent context and clear the recorder.
+	void                submit();
+
+	void                setColor(Color _color)           { m_color = _color; }
+	Color               getColor() const                 { return m_color;   }
+	void                setAlpha(float _alpha)           { m_alpha = _alpha; }
+	float               getAlpha() const                 { return m_alpha;   }
+	void                setSize(float _size)             { m_size = _size;   }
+	float               getSize() const                  { return m_size;    }
+	void                setEnableSorting(bool _enable)   { IM3D_ASSERT(m_primMode == PrimitiveMode_None); m_enableSorting = _enable; }
+	bool                getEnableSorting() const         { return m_enableSorting; }
+	void                setLayerId(Id _layer);
+	Id                  getLayerId() const               { return m_layerId; }
+	void                setMatrix(const Mat4& _mat4)     { m_matrix = _mat4; m_useMatrix = true; }
+	const Mat4&         getMatrix() const                { return m_matrix;  }
+
+	Context&            getParent()                      { return *m_parent; }
+	U32                 getVertexCount() const           { return m_vertexCount; }
+
+private:
+
+	struct Batch // run of consecutive vertices with the same layer/primitive type/sorting
+	{
+		Id                m_layerId;
+		DrawPrimitiveType m_primType;
+		bool              m_sorted;
+		U32               m_vertexCount;
+	};
+	enum { InlineBatchCount = 4 };
+
+	Context*            m_parent;
+
+ // Draw state.
+	Color               m_color;
+	float               m_alpha;
+	float               m_size;
+	bool                m_enableSorting;
+	Id                  m_layerId;
+	LayerPolicy         m_layerPolicy;                      // Copied from the parent for m_layerId.
+	Mat4                m_matrix;
+	bool                m_useMatrix;                        // False if m_matrix is identity.
+	bool                m_culled;                           // Parent cull scope was culled, discard vertices.
+	bool                m_discardThisPrim;                  // m_culled or m_alpha is 0.
+
+ // Primitive state.
+	PrimitiveMode       m_primMode;
+	DrawPrimitiveType   m_primType;
+	U32                 m_firstVertThisPrim;
+	U32                 m_vertCountThisPrim;
+	Vec3                m_minVertThisPrim;
+	Vec3                m_maxVertThisPrim;
+	U32                 m_culledPrimitiveCount[DrawPrimitive_Count]; // Culled by end(), added to the parent's count by submit().
+
+ // Vertex data, initially points to the inline storage.
+	VertexData*         m_vertexData;
+	U32                 m_vertexCount;
+	U32                 m_vertexCapacity;
+	Batch*              m_batches;
+	U32                 m_batchCount;
+	U32                 m_batchCapacity;
+
+	alignas(VertexData) char m_inlineVertexData[sizeof(VertexData) * IM3D_RECORDER_INLINE_VERTEX_COUNT]; // Uninitialized.
+	Batch               m_inlineBatches[InlineBatchCount];
+
+	void                pushVertex(VertexData _vd);
+
+	                    Recorder(const Recorder&);
+	Recorder&           operator=(const Recorder&);
 };
 
 namespace internal {
@@ -806,96 +1446,253 @@ namespace internal {
 
 extern IM3D_THREAD_LOCAL Context* g_CurrentContext;
 
+// Return the bound context (see GetContext()).
+#ifdef IM3D_CONTEXT_LOOKUP
+inline Context&            GetBoundContext()                                                                                { return IM3D_CONTEXT_LOOKUP(); }
+#else
+inline Context&            GetBoundContext()                                                                                { return *g_CurrentContext; }
+#endif
+
 }
 
-inline AppData&            GetAppData()                                                                                     { return GetContext().getAppData(); }
-inline void                NewFrame()                                                                                       { GetContext().reset(); }
-inline void                EndFrame()                                                                                       { GetContext().endFrame(); }
-inline void                Draw()                                                                                           { GetContext().draw(); }
-
-inline const DrawList*     GetDrawLists()                                                                                   { return GetContext().getDrawLists(); }
-inline U32                 GetDrawListCount()                                                                               { return GetContext().getDrawListCount(); }
-
-inline const TextDrawList* GetTextDrawLists()                                                                               { return GetContext().getTextDrawLists(); }
-inline U32                 GetTextDrawListCount()                                                                           { return GetContext().getTextDrawListCount(); }
-
-inline void                BeginPoints()                                                                                    { GetContext().begin(PrimitiveMode_Points); }
-inline void                BeginLines()                                                                                     { GetContext().begin(PrimitiveMode_Lines); }
-inline void                BeginLineLoop()                                                                                  { GetContext().begin(PrimitiveMode_LineLoop); }
-inline void                BeginLineStrip()                                                                                 { GetContext().begin(PrimitiveMode_LineStrip); }
-inline void                BeginTriangles()                                                                                 { GetContext().begin(PrimitiveMode_Triangles); }
-inline void                BeginTriangleStrip()                                                                             { GetContext().begin(PrimitiveMode_TriangleStrip); }
-inline void                End()                                                                                            { GetContext().end(); }
-
-inline void                Vertex(const Vec3& _position)                                                                    { GetContext().vertex(_position, GetContext().getSize(), GetContext().getColor()); }
-inline void                Vertex(const Vec3& _position, Color _color)                                                      { GetContext().vertex(_position, GetContext().getSize(), _color); }
-inline void                Vertex(const Vec3& _position, float _size)                                                       { GetContext().vertex(_position, _size, GetContext().getColor()); }
-inline void                Vertex(const Vec3& _position, float _size, Color _color)                                         { GetContext().vertex(_position, _size, _color); }
-inline void                Vertex(float _x, float _y, float _z)                                                             { Vertex(Vec3(_x, _y, _z)); }
-inline void                Vertex(float _x, float _y, float _z, Color _color)                                               { Vertex(Vec3(_x, _y, _z), _color); }
-inline void                Vertex(float _x, float _y, float _z, float _size)                                                { Vertex(Vec3(_x, _y, _z), _size); }
-inline void                Vertex(float _x, float _y, float _z, float _size, Color _color)                                  { Vertex(Vec3(_x, _y, _z), _size, _color); }
-
-inline void                PushDrawState()                                                                                  { Context& ctx = GetContext(); ctx.pushColor(ctx.getColor()); ctx.pushAlpha(ctx.getAlpha()); ctx.pushSize(ctx.getSize()); ctx.pushEnableSorting(ctx.getEnableSorting()); }
-inline void                PopDrawState()                                                                                   { Context& ctx = GetContext(); ctx.popColor(); ctx.popAlpha(); ctx.popSize(); ctx.popEnableSorting(); }
-
-inline void                PushColor()                                                                                      { GetContext().pushColor(GetContext().getColor()); }
+// Frame functions always operate on the bound context, never on a per-thread producer.
+inline AppData&            GetAppData()                                                                                     { return internal::GetBoundContext().getAppData(); }
+inline void                NewFrame()                                                                                       { internal::GetBoundContext().reset(); }
+inline void                EndFrame()                                                                                       { internal::GetBoundContext().endFrame(); }
+inline void                Draw()                                                                                           { internal::GetBoundContext().draw(); }
+
+inline const DrawList*     GetDrawLists()                                                                                   { return internal::GetBoundContext().getDrawLists(); }
+inline U32                 GetDrawListCount()                                                                               { return internal::GetBoundContext().getDrawListCount(); }
+
+inline const TextDrawList* GetTextDrawLists()                                                                               { return internal::GetBoundContext().getTextDrawLists(); }
+inline U32                 GetTextDrawListCount()                                                                           { return internal::GetBoundContext().getTextDrawListCount(); }
+inline const TextQuadList* GetTextQuadLists()                                                                               { return internal::GetBoundContext().getTextQuadLists(); }
+inline U32                 GetTextQuadListCount()                                                                           { return internal::GetBoundContext().getTextQuadListCount(); }
+
+inline void                BeginPoints(Context& _ctx)                                                                       { _ctx.begin(PrimitiveMode_Points); }
+inline void                BeginLines(Context& _ctx)                                                                        { _ctx.begin(PrimitiveMode_Lines); }
+inline void                BeginLineLoop(Context& _ctx)                                                                     { _ctx.begin(PrimitiveMode_LineLoop); }
+inline void                BeginLineStrip(Context& _ctx)                                                                    { _ctx.begin(PrimitiveMode_LineStrip); }
+inline void                BeginTriangles(Context& _ctx)                                                                    { _ctx.begin(PrimitiveMode_Triangles); }
+inline void                BeginTriangleStrip(Context& _ctx)                                                                { _ctx.begin(PrimitiveMode_TriangleStrip); }
+inline void                End(Context& _ctx)                                                                               { _ctx.end(); }
+
+inline void                BeginPoints()                                                                                    { BeginPoints(GetContext()); }
+inline void                BeginLines()                                                                                     { BeginLines(GetContext()); }
+inline void                BeginLineLoop()                                                                                  { BeginLineLoop(GetContext()); }
+inline void                BeginLineStrip()                                                                                 { BeginLineStrip(GetContext()); }
+inline void                BeginTriangles()                                                                                 { BeginTriangles(GetContext()); }
+inline void                BeginTriangleStrip()                                                                             { BeginTriangleStrip(GetContext()); }
+inline void                End()                                                                                            { End(GetContext()); }
+
+inline void                Vertex(Context& _ctx, const Vec3& _position)                                                     { _ctx.vertex(_position, _ctx.getSize(), _ctx.getColor()); }
+inline void                Vertex(Context& _ctx, const Vec3& _position, Color _color)                                       { _ctx.vertex(_position, _ctx.getSize(), _color); }
+inline void                Vertex(Context& _ctx, const Vec3& _position, float _size)                                        { _ctx.vertex(_position, _size, _ctx.getColor()); }
+inline void                Vertex(Context& _ctx, const Vec3& _position, float _size, Color _color)                          { _ctx.vertex(_position, _size, _color); }
+inline void                Vertex(Context& _ctx, float _x, float _y, float _z)                                              { Vertex(_ctx, Vec3(_x, _y, _z)); }
+inline void                Vertex(Context& _ctx, float _x, float _y, float _z, Color _color)                                { Vertex(_ctx, Vec3(_x, _y, _z), _color); }
+inline void                Vertex(Context& _ctx, float _x, float _y, float _z, float _size)                                 { Vertex(_ctx, Vec3(_x, _y, _z), _size); }
+inline void                Vertex(Context& _ctx, float _x, float _y, float _z, float _size, Color _color)                   { Vertex(_ctx, Vec3(_x, _y, _z), _size, _color); }
+
+inline void                Vertex(const Vec3& _position)                                                                    { Vertex(GetContext(), _position); }
+inline void                Vertex(const Vec3& _position, Color _color)                                                      { Vertex(GetContext(), _position, _color); }
+inline void                Vertex(const Vec3& _position, float _size)                                                       { Vertex(GetContext(), _position, _size); }
+inline void                Vertex(const Vec3& _position, float _size, Color _color)                                         { Vertex(GetContext(), _position, _size, _color); }
+inline void                Vertex(float _x, float _y, float _z)                                                             { Vertex(GetContext(), Vec3(_x, _y, _z)); }
+inline void                Vertex(float _x, float _y, float _z, Color _color)                                               { Vertex(GetContext(), Vec3(_x, _y, _z), _color); }
+inline void                Vertex(float _x, float _y, float _z, float _size)                                                { Vertex(GetContext(), Vec3(_x, _y, _z), _size); }
+inline void                Vertex(float _x, float _y, float _z, float _size, Color _color)                                  { Vertex(GetContext(), Vec3(_x, _y, _z), _size, _color); }
+
+inline void                PushDrawState(Context& _ctx)                                                                     { _ctx.pushColor(_ctx.getColor()); _ctx.pushAlpha(_ctx.getAlpha()); _ctx.pushSize(_ctx.getSize()); _ctx.pushEnableSorting(_ctx.getEnableSorting()); }
+inline void                PopDrawState(Context& _ctx)                                                                      { _ctx.popColor(); _ctx.popAlpha(); _ctx.popSize(); _ctx.popEnableSorting(); }
+inline void                PushDrawState()                                                                                  { PushDrawState(GetContext()); }
+inline void                PopDrawState()                                                                                   { PopDrawState(GetContext()); }
+
+inline void                PushColor(Context& _ctx)                                                                         { _ctx.pushColor(_ctx.getColor()); }
+inline void                PushColor(Context& _ctx, Color _color)                                                           { _ctx.pushColor(_color); }
+inline void                PopColor(Context& _ctx)                                                                          { _ctx.popColor(); }
+inline void                SetColor(Context& _ctx, Color _color)                                                            { _ctx.setColor(_color); }
+inline void                SetColor(Context& _ctx, float _r, float _g, float _b, float _a)                                  { _ctx.setColor(Color(_r, _g, _b, _a)); }
+inline Color               GetColor(Context& _ctx)                                                                          { return _ctx.getColor(); }
+inline void                PushColor()                                                                                      { PushColor(GetContext()); }
 inline void                PushColor(Color _color)                                                                          { GetContext().pushColor(_color); }
 inline void                PopColor()                                                                                       { GetContext().popColor(); }
 inline void                SetColor(Color _color)                                                                           { GetContext().setColor(_color); }
 inline void                SetColor(float _r, float _g, float _b, float _a)                                                 { GetContext().setColor(Color(_r, _g, _b, _a)); }
 inline Color               GetColor()                                                                                       { return GetContext().getColor(); }
 
-inline void                PushAlpha()                                                                                      { GetContext().pushAlpha(GetContext().getAlpha()); }
+inline void                PushAlpha(Context& _ctx)                                                                         { _ctx.pushAlpha(_ctx.getAlpha()); }
+inline void                PushAlpha(Context& _ctx, float _alpha)                                                           { _ctx.pushAlpha(_alpha); }
+inline void                PopAlpha(Context& _ctx)                                                                          { _ctx.popAlpha(); }
+inline void                SetAlpha(Context& _ctx, float _alpha)                                                            { _ctx.setAlpha(_alpha); }
+inline float               GetAlpha(Context& _ctx)                                                                          { return _ctx.getAlpha(); }
+inline void                PushAlpha()                                                                                      { PushAlpha(GetContext()); }
 inline void                PushAlpha(float _alpha)                                                                          { GetContext().pushAlpha(_alpha); }
 inline void                PopAlpha()                                                                                       { GetContext().popAlpha(); }
 inline void                SetAlpha(float _alpha)                                                                           { GetContext().setAlpha(_alpha); }
 inline float               GetAlpha()                                                                                       { return GetContext().getAlpha(); }
 
-inline void                PushSize()                                                                                       { GetContext().pushSize(GetContext().getAlpha()); }
+inline void                PushSize(Context& _ctx)                                                                          { _ctx.pushSize(_ctx.getSize()); }
+inline void                PushSize(Context& _ctx, float _size)                                                             { _ctx.pushSize(_size); }
+inline void                PopSize(Context& _ctx)                                                                           { _ctx.popSize(); }
+inline void                SetSize(Context& _ctx, float _size)                                                              { _ctx.setSize(_size); }
+inline float               GetSize(Context& _ctx)                                                                           { return _ctx.getSize(); }
+inline void                PushSize()                                                                                       { PushSize(GetContext()); }
 inline void                PushSize(float _size)                                                                            { GetContext().pushSize(_size); }
 inline void                PopSize()                                                                                        { GetContext().popSize(); }
 inline void                SetSize(float _size)                                                                             { GetContext().setSize(_size); }
 inline float               GetSize()                                                                                        { return GetContext().getSize(); }
 
-inline void                PushEnableSorting()                                                                              { GetContext().pushEnableSorting(GetContext().getEnableSorting()); }
+inline void                PushEnableSorting(Context& _ctx)                                                                 { _ctx.pushEnableSorting(_ctx.getEnableSorting()); }
+inline void                PushEnableSorting(Context& _ctx, bool _enable)                                                   { _ctx.pushEnableSorting(_enable); }
+inline void                PopEnableSorting(Context& _ctx)                                                                  { _ctx.popEnableSorting(); }
+inline void                EnableSorting(Context& _ctx, bool _enable)                                                       { _ctx.setEnableSorting(_enable); }
+inline void                PushEnableSorting()                                                                              { PushEnableSorting(GetContext()); }
 inline void                PushEnableSorting(bool _enable)                                                                  { GetContext().pushEnableSorting(_enable); }
 inline void                PopEnableSorting()                                                                               { GetContext().popEnableSorting(); }
 inline void                EnableSorting(bool _enable)                                                                      { GetContext().setEnableSorting(_enable); }
 
-inline void                PushMatrix()                                                                                     { GetContext().pushMatrix(GetContext().getMatrix()); }
+inline void                PushMatrix(Context& _ctx)                                                                        { _ctx.pushMatrix(_ctx.getMatrix()); }
+inline void                PushMatrix(Context& _ctx, const Mat4& _mat4)                                                     { _ctx.pushMatrix(_mat4); }
+inline void                PopMatrix(Context& _ctx)                                                                         { _ctx.popMatrix(); }
+inline void                SetMatrix(Context& _ctx, const Mat4& _mat4)                                                      { _ctx.setMatrix(_mat4); }
+inline void                SetIdentity(Context& _ctx)                                                                       { _ctx.setMatrix(Mat4(1.0f)); }
+inline void                PushMatrix()                                                                                     { PushMatrix(GetContext()); }
 inline void                PushMatrix(const Mat4& _mat4)                                                                    { GetContext().pushMatrix(_mat4); }
 inline void                PopMatrix()                                                                                      { GetContext().popMatrix(); }
 inline void                SetMatrix(const Mat4& _mat4)                                                                     { GetContext().setMatrix(_mat4); }
-inline void                SetIdentity()                                                                                    { GetContext().setMatrix(Mat4(1.0f)); }
+inline void                SetIdentity()                                                                                    { SetIdentity(GetContext()); }
+inline void                MulMatrix(const Mat4& _mat4)                                                                     { MulMatrix(GetContext(), _mat4); }
+inline void                Translate(float _x, float _y, float _z)                                                          { Translate(GetContext(), _x, _y, _z); }
+inline void                Translate(const Vec3& _vec3)                                                                     { Translate(GetContext(), _vec3); }
+inline void                Rotate(const Vec3& _axis, float _angle)                                                          { Rotate(GetContext(), _axis, _angle); }
+inline void                Rotate(const Mat3& _rotation)                                                                    { Rotate(GetContext(), _rotation); }
+inline void                Scale(float _x, float _y, float _z)                                                              { Scale(GetContext(), _x, _y, _z); }
+
+inline void                DrawXyzAxes()                                                                                    { DrawXyzAxes(GetContext()); }
+inline void                DrawPoint(const Vec3& _position, float _size, Color _color)                                      { DrawPoint(GetContext(), _position, _size, _color); }
+inline void                DrawLine(const Vec3& _a, const Vec3& _b, float _size, Color _color)                              { DrawLine(GetContext(), _a, _b, _size, _color); }
+inline void                DrawQuad(const Vec3& _a, const Vec3& _b, const Vec3& _c, const Vec3& _d)                         { DrawQuad(GetContext(), _a, _b, _c, _d); }
+inline void                DrawQuad(const Vec3& _origin, const Vec3& _normal, const Vec2& _size)                            { DrawQuad(GetContext(), _origin, _normal, _size); }
+inline void                DrawQuadFilled(const Vec3& _a, const Vec3& _b, const Vec3& _c, const Vec3& _d)                   { DrawQuadFilled(GetContext(), _a, _b, _c, _d); }
+inline void                DrawQuadFilled(const Vec3& _origin, const Vec3& _normal, const Vec2& _size)                      { DrawQuadFilled(GetContext(), _origin, _normal, _size); }
+inline void                DrawCircle(const Vec3& _origin, const Vec3& _normal, float _radius, int _detail)                 { DrawCircle(GetContext(), _origin, _normal, _radius, _detail); }
+inline void                DrawCircleFilled(const Vec3& _origin, const Vec3& _normal, float _radius, int _detail)           { DrawCircleFilled(GetContext(), _origin, _normal, _radius, _detail); }
+inline void                DrawSphere(const Vec3& _origin, float _radius, int _detail)                                      { DrawSphere(GetContext(), _origin, _radius, _detail); }
+inline void                DrawSphereFilled(const Vec3& _origin, float _radius, int _detail)                                { DrawSphereFilled(GetContext(), _origin, _radius, _detail); }
+inline void                DrawAlignedBox(const Vec3& _min, const Vec3& _max)                                               { DrawAlignedBox(GetContext(), _min, _max); }
+inline void                DrawAlignedBoxFilled(const Vec3& _min, const Vec3& _max)                                         { DrawAlignedBoxFilled(GetContext(), _min, _max); }
+inline void                DrawCylinder(const Vec3& _start, const Vec3& _end, float _radius, int _detail)                   { DrawCylinder(GetContext(), _start, _end, _radius, _detail); }
+inline void                DrawCylinderFilled(const Vec3& _start, const Vec3& _end, float _radius, bool _drawCapStart, bool _drawCapEnd, int _detail) { DrawCylinderFilled(GetContext(), _start, _end, _radius, _drawCapStart, _drawCapEnd, _detail); }
+inline void                DrawCapsule(const Vec3& _start, const Vec3& _end, float _radius, int _detail)                    { DrawCapsule(GetContext(), _start, _end, _radius, _detail); }
+inline void                DrawPrism(const Vec3& _start, const Vec3& _end, float _radius, int _sides)                       { DrawPrism(GetContext(), _start, _end, _radius, _sides); }
+inline void                DrawArrow(const Vec3& _start, const Vec3& _end, float _headLength, float _headThickness)         { DrawArrow(GetContext(), _start, _end, _headLength, _headThickness); }
+inline void                DrawCone2(const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, int _detail) { DrawCone2(GetContext(), _start, _end, _radiusStart, _radiusEnd, _detail); }
+inline void                DrawConeFilled2(const Vec3& _start, const Vec3& _end, float _radiusStart, float _radiusEnd, bool _drawCapStart, bool _drawCapEnd, int _detail) { DrawConeFilled2(GetContext(), _start, _end, _radiusStart, _radiusEnd, _drawCapStart, _drawCapEnd, _detail); }
+#if IM3D_USE_DEPRECATED_DRAW_CONE
+inline void                DrawCone(const Vec3& _origin, const Vec3& _normal, float height, float _radius, int _detail)     { DrawCone(GetContext(), _origin, _normal, height, _radius, _detail); }
+inline void                DrawConeFilled(const Vec3& _origin, const Vec3& _normal, float height, float _radius, int _detail) { DrawConeFilled(GetContext(), _origin, _normal, height, _radius, _detail); }
+#endif
 
-inline void                PushId()                                                                                         { GetContext().pushId(GetContext().getId()); }
+inline Id                  MakeId(const char* _str)                                                                         { return MakeId(GetContext(), _str); }
+inline Id                  MakeId(const void* _ptr)                                                                         { return MakeId(GetContext(), _ptr); }
+inline Id                  MakeId(int _i)                                                                                   { return MakeId(GetContext(), _i); }
+inline Id                  MakeId(Context& _ctx, StaticId _id)                                                              { return (_ctx.getId() ^ _id.m_hash) * internal::kFnv1aPrime32; }
+inline Id                  MakeId(StaticId _id)                                                                             { return MakeId(GetContext(), _id); }
+
+inline void                PushId(Context& _ctx)                                                                            { _ctx.pushId(_ctx.getId()); }
+inline void                PushId(Context& _ctx, Id _id)                                                                    { _ctx.pushId(_id); }
+inline void                PushId(Context& _ctx, const char* _str)                                                          { _ctx.pushId(MakeId(_ctx, _str)); }
+inline void                PushId(Context& _ctx, const void* _ptr)                                                          { _ctx.pushId(MakeId(_ctx, _ptr)); }
+inline void                PushId(Context& _ctx, int _i)                                                                    { _ctx.pushId(MakeId(_ctx, _i)); }
+inline void                PushId(Context& _ctx, StaticId _id)                                                              { _ctx.pushId(MakeId(_ctx, _id)); }
+inline void                PopId(Context& _ctx)                                                                             { _ctx.popId(); }
+inline Id                  GetId(Context& _ctx)                                                                             { return _ctx.getId(); }
+inline void                PushId()                                                                                         { PushId(GetContext()); }
 inline void                PushId(Id _id)                                                                                   { GetContext().pushId(_id); }
-inline void                PushId(const char* _str)                                                                         { GetContext().pushId(MakeId(_str)); }
-inline void                PushId(const void* _ptr)                                                                         { GetContext().pushId(MakeId(_ptr)); }
-inline void                PushId(int _i)                                                                                   { GetContext().pushId(MakeId(_i)); }
+inline void                PushId(const char* _str)                                                                         { PushId(GetContext(), _str); }
+inline void                PushId(const void* _ptr)                                                                         { PushId(GetContext(), _ptr); }
+inline void                PushId(int _i)                                                                                   { PushId(GetContext(), _i); }
+inline void                PushId(StaticId _id)                                                                             { PushId(GetContext(), _id); }
 inline void                PopId()                                                                                          { GetContext().popId(); }
 inline Id                  GetId()                                                                                          { return GetContext().getId(); }
 
-inline void                PushLayerId()                                                                                    { GetContext().pushLayerId(GetContext().getLayerId()); }
+inline void                PushLayerId(Context& _ctx, Id _layer)                                                            { _ctx.pushLayerId(_layer); }
+inline void                PushLayerId(Context& _ctx, const char* _str)                                                     { _ctx.pushLayerId(MakeId(_ctx, _str)); }
+inline void                PopLayerId(Context& _ctx)                                                                        { _ctx.popLayerId(); }
+inline Id                  GetLayerId(Context& _ctx)                                                                        { return _ctx.getLayerId(); }
+inline void                PushLayerId()                                                                                    { Context& ctx = GetContext(); ctx.pushLayerId(ctx.getLayerId()); }
 inline void                PushLayerId(Id _layer)                                                                           { GetContext().pushLayerId(_layer); }
-inline void                PushLayerId(const char* _str)                                                                    { PushLayerId(MakeId(_str)); }
+inline void                PushLayerId(const char* _str)                                                                    { PushLayerId(GetContext(), _str); }
 inline void                PopLayerId()                                                                                     { GetContext().popLayerId(); }
 inline Id                  GetLayerId()                                                                                     { return GetContext().getLayerId(); }
 
-inline bool                GizmoTranslation(const char* _id, float _translation_[3], bool _local)                           { return GizmoTranslation(MakeId(_id), _translation_, _local);   }
-inline bool                GizmoRotation(const char* _id, float _rotation_[3*3], bool _local)                               { return GizmoRotation(MakeId(_id), _rotation_, _local);}
-inline bool                GizmoScale(const char* _id, float _scale_[3])                                                    { return GizmoScale(MakeId(_id), _scale_); }
-inline bool                Gizmo(const char* _id, float _translation_[3], float _rotation_[3*3], float _scale_[3])          { return Gizmo(MakeId(_id), _translation_, _rotation_, _scale_); }
-inline bool                Gizmo(const char* _id, float _transform_[4*4])                                                   { return Gizmo(MakeId(_id), _transform_); }
+inline bool                GizmoTranslation(Context& _ctx, const char* _id, float _translation_[3], bool _local)            { return GizmoTranslation(_ctx, MakeId(_ctx, _id), _translation_, _local); }
+inline bool                GizmoRotation(Context& _ctx, const char* _id, float _rotation_[3*3], bool _local)                { return GizmoRotation(_ctx, MakeId(_ctx, _id), _rotation_, _local); }
+inline bool                GizmoScale(Context& _ctx, const char* _id, float _scale_[3])                                     { return GizmoScale(_ctx, MakeId(_ctx, _id), _scale_); }
+inline bool                Gizmo(Context& _ctx, const char* _id, float _translation_[3], float _rotation_[3*3], float _scale_[3]) { return Gizmo(_ctx, MakeId(_ctx, _id), _translation_, _rotation_, _scale_); }
+inline bool                Gizmo(Context& _ctx, const char* _id, float _transform_[4*4])                                    { return Gizmo(_ctx, MakeId(_ctx, _id), _transform_); }
+inline bool                GizmoWasActivated(Context& _ctx)                                                                 { return _ctx.idWasActivated(); }
+inline Id                  GetActiveId(Context& _ctx)                                                                       { return _ctx.m_appActiveId; }
+inline Id                  GetHotId(Context& _ctx)                                                                          { return _ctx.m_appHotId; }
+inline void                PickSphere(Context& _ctx, Id _id, const Vec3& _origin, float _radius)                            { _ctx.pickSphere(_id, _origin, _radius); }
+inline void                PickBox(Context& _ctx, Id _id, const Vec3& _min, const Vec3& _max)                               { _ctx.pickBox(_id, _min, _max); }
+inline void                PickCapsule(Context& _ctx, Id _id, const Vec3& _start, const Vec3& _end, float _radius)          { _ctx.pickCapsule(_id, _start, _end, _radius); }
+inline void                PickSpheres(Context& _ctx, const Id* _ids, const Vec3* _origins, const float* _radii, U32 _count) { _ctx.pickSpheres(_ids, _origins, _radii, _count); }
+inline void                PickBoxes(Context& _ctx, const Id* _ids, const Vec3* _min, const Vec3* _max, U32 _count)       { _ctx.pickBoxes(_ids, _min, _max, _count); }
+inline Id                  GetPickId(Context& _ctx)                                                                         { return _ctx.getPickId(); }
+inline bool                GizmoTranslation(const char* _id, float _translation_[3], bool _local)                           { return GizmoTranslation(GetContext(), _id, _translation_, _local); }
+inline bool                GizmoRotation(const char* _id, float _rotation_[3*3], bool _local)                               { return GizmoRotation(GetContext(), _id, _rotation_, _local); }
+inline bool                GizmoScale(const char* _id, float _scale_[3])                                                    { return GizmoScale(GetContext(), _id, _scale_); }
+inline bool                Gizmo(const char* _id, float _translation_[3], float _rotation_[3*3], float _scale_[3])          { return Gizmo(GetContext(), _id, _translation_, _rotation_, _scale_); }
+inline bool                Gizmo(const char* _id, float _transform_[4*4])                                                   { return Gizmo(GetContext(), _id, _transform_); }
+inline bool                GizmoTranslation(Id _id, float _translation_[3], bool _local)                                    { return GizmoTranslation(GetContext(), _id, _translation_, _local); }
+inline bool                GizmoRotation(Id _id, float _rotation_[3*3], bool _local)                                        { return GizmoRotation(GetContext(), _id, _rotation_, _local); }
+inline bool                GizmoScale(Id _id, float _scale_[3])                                                             { return GizmoScale(GetContext(), _id, _scale_); }
+inline bool                Gizmo(Id _id, float _transform_[4*4])                                                            { return Gizmo(GetContext(), _id, _transform_); }
+inline bool                Gizmo(Id _id, float _translation_[3], float _rotation_[3*3], float _scale_[3])                   { return Gizmo(GetContext(), _id, _translation_, _rotation_, _scale_); }
+inline bool                GizmoGroup(Id _id, float _pivot_[4*4], float* _transforms_, U32 _count, U32 _stride)            { return GizmoGroup(GetContext(), _id, _pivot_, _transforms_, _count, _stride); }
+inline bool                GizmoGroup(Id _id, float _pivot_[4*4], float* _translations_, float* _rotations_, float* _scales_, U32 _count) { return GizmoGroup(GetContext(), _id, _pivot_, _translations_, _rotations_, _scales_, _count); }
 inline bool                GizmoWasActivated()                                                                              { return GetContext().idWasActivated(); }
 inline Id                  GetActiveId()                                                                                    { return GetContext().m_appActiveId;}
 inline Id                  GetHotId()                                                                                       { return GetContext().m_appHotId; }
-
+inline void                PickSphere(Id _id, const Vec3& _origin, float _radius)                                           { GetContext().pickSphere(_id, _origin, _radius); }
+inline void                PickBox(Id _id, const Vec3& _min, const Vec3& _max)                                              { GetContext().pickBox(_id, _min, _max); }
+inline void                PickCapsule(Id _id, const Vec3& _start, const Vec3& _end, float _radius)                         { GetContext().pickCapsule(_id, _start, _end, _radius); }
+inline void                PickSpheres(const Id* _ids, const Vec3* _origins, const float* _radii, U32 _count)               { GetContext().pickSpheres(_ids, _origins, _radii, _count); }
+inline void                PickBoxes(const Id* _ids, const Vec3* _min, const Vec3* _max, U32 _count)                      { GetContext().pickBoxes(_ids, _min, _max, _count); }
+inline Id                  GetPickId()                                                                                      { return internal::GetBoundContext().getPickId(); }
+
+inline bool                IsVisible(Context& _ctx, const Vec3& _origin, float _radius)                                     { return _ctx.isVisible(_origin, _radius); }
+inline bool                IsVisible(Context& _ctx, const Vec3& _min, const Vec3& _max)                                     { return _ctx.isVisible(_min, _max); }
 inline bool                IsVisible(const Vec3& _origin, float _radius)                                                    { return GetContext().isVisible(_origin, _radius); }
 inline bool                IsVisible(const Vec3& _min, const Vec3& _max)                                                    { return GetContext().isVisible(_min, _max);}
-
-inline Context&            GetContext()                                                                                     { return *internal::g_CurrentContext; }
+inline void                IsVisible(Context& _ctx, const Vec3* _origins, const float* _radii, U32 _count, U32* _visible_) { _ctx.isVisible(_origins, _radii, _count, _visible_); }
+inline void                IsVisible(Context& _ctx, const Vec3* _min, const Vec3* _max, U32 _count, U32* _visible_)       { _ctx.isVisible(_min, _max, _count, _visible_); }
+inline void                IsVisible(const Vec3* _origins, const float* _radii, U32 _count, U32* _visible_)               { GetContext().isVisible(_origins, _radii, _count, _visible_); }
+inline void                IsVisible(const Vec3* _min, const Vec3* _max, U32 _count, U32* _visible_)                     { GetContext().isVisible(_min, _max, _count, _visible_); }
+
+inline void                PushCullBounds(Context& _ctx, const Vec3& _min, const Vec3& _max)                                { _ctx.pushCullBounds(_min, _max); }
+inline void                PushCullSphere(Context& _ctx, const Vec3& _origin, float _radius)                                { _ctx.pushCullSphere(_origin, _radius); }
+inline void                PopCullBounds(Context& _ctx)                                                                     { _ctx.popCullBounds(); }
+inline void                PushCullBounds(const Vec3& _min, const Vec3& _max)                                               { GetContext().pushCullBounds(_min, _max); }
+inline void                PushCullSphere(const Vec3& _origin, float _radius)                                               { GetContext().pushCullSphere(_origin, _radius); }
+inline void                PopCullBounds()                                                                                  { GetContext().popCullBounds(); }
+
+inline void                TextUnformatted(const Vec3& _position, U32 _textFlags, const char* _textStart, const char* _textEnd)                            { TextUnformatted(GetContext(), _position, _textFlags, _textStart, _textEnd); }
+inline void                TextUnformatted(const Vec3& _position, float _size, Color _color, U32 _textFlags, const char* _textStart, const char* _textEnd) { TextUnformatted(GetContext(), _position, _size, _color, _textFlags, _textStart, _textEnd); }
+inline Id                  InternText(Context& _ctx, const char* _textStart, const char* _textEnd)                          { return _ctx.internText(_textStart, _textEnd); }
+inline void                TextInterned(Context& _ctx, const Vec3& _position, U32 _textFlags, Id _textId)                   { _ctx.text(_position, _ctx.getSize(), _ctx.getColor(), (TextFlags)_textFlags, _textId); }
+inline void                TextInterned(Context& _ctx, const Vec3& _position, float _size, Color _color, U32 _textFlags, Id _textId) { _ctx.text(_position, _size, _color, (TextFlags)_textFlags, _textId); }
+inline Id                  InternText(const char* _textStart, const char* _textEnd)                                         { return GetContext().internText(_textStart, _textEnd); }
+inline void                TextInterned(const Vec3& _position, U32 _textFlags, Id _textId)                                  { TextInterned(GetContext(), _position, _textFlags, _textId); }
+inline void                TextInterned(const Vec3& _position, float _size, Color _color, U32 _textFlags, Id _textId)      { TextInterned(GetContext(), _position, _size, _color, _textFlags, _textId); }
+
+#if IM3D_THREAD_SAFE_SUBMISSION
+inline Context&            GetContext()                                                                                     { return internal::GetBoundContext().getThreadContext(); }
+#else
+inline Context&            GetContext()                                                                                     { return internal::GetBoundContext(); }
+#endif
 inline void                SetContext(Context& _ctx)                                                                        { internal::g_CurrentContext = &_ctx; }
 inline void                MergeContexts(Context& _dst_, const Context& _src)                                               { _dst_.merge(_src); }
 
@@ -16,18 +16,47 @@
 // Use a thread-local context pointer.
 //#define IM3D_THREAD_LOCAL_CONTEXT_PTR 1
 
+// Allow Im3d calls from any thread without per-thread contexts. Each thread submits to its own producer context, which is created on
+// first use and merged into the current context during EndFrame(). See Context::getThreadContext().
+//#define IM3D_THREAD_SAFE_SUBMISSION 1
+
+// Producer contexts (IM3D_THREAD_SAFE_SUBMISSION) which the owning thread hasn't requested via Context::getThreadContext() for this many
+// frames are destroyed during reset(), e.g. after the thread exits (default is 60, 0 = never).
+//#define IM3D_PRODUCER_IDLE_FRAMES 60
+
+// Override the context lookup used by GetContext() and the frame functions, e.g. to bind contexts to fibers or jobs rather than threads.
+// The function must be declared before im3d.h is included. SetContext() has no effect when this is defined.
+//#define IM3D_CONTEXT_LOOKUP() MyGetIm3dContext()
+
 // Use row-major internal matrix layout.
 //#define IM3D_MATRIX_ROW_MAJOR 1
 
 // Force vertex data alignment (default is 4 bytes).
 //#define IM3D_VERTEX_ALIGNMENT 4
 
+// Number of vertices stored inline by Im3d::Recorder before it allocates (default is 64).
+//#define IM3D_RECORDER_INLINE_VERTEX_COUNT 64
+
 // Enable internal culling for primitives (everything drawn between Begin*()/End()). The application must set a culling frustum via AppData.
 //#define IM3D_CULL_PRIMITIVES 1
 
 // Enable internal culling for gizmos. The application must set a culling frustum via AppData.
 //#define IM3D_CULL_GIZMOS 1
 
+// Cull individual points/lines/triangles during EndFrame(), accounting for point/line size. More precise than IM3D_CULL_PRIMITIVES (which
+// culls whole Begin*()/End() blocks), e.g. long line strips which cross the view are reduced to the visible segments. The application
+// must set a culling frustum via AppData.
+//#define IM3D_CULL_PRIMITIVES_POST_PASS 1
+
+// Cull text whose position is outside the cull frustum during EndFrame(). The application must set a culling frustum via AppData.
+//#define IM3D_CULL_TEXT 1
+
+// Remove fully transparent points/lines/triangles, zero-length lines and zero-area triangles during EndFrame().
+//#define IM3D_COMPACT_PRIMITIVES 1
+
+// Use SSE for batched visibility tests (enabled by default if the target supports SSE2).
+//#define IM3D_SSE 0
+
 // Set a layer ID for all gizmos to use internally.
 //#define IM3D_GIZMO_LAYER_ID 0xD4A1B5
 